@@ -0,0 +1,103 @@
+#include "arena.h"
+#include <new>
+
+using namespace std;
+
+const size_t Arena::GRANULE;
+const size_t Arena::MAX_SMALL;
+
+// empty arena, slabs are allocated slabSize bytes at a time
+Arena::Arena(size_t slabSize)
+    : slabSize(slabSize < MAX_SMALL ? MAX_SMALL : slabSize), next(nullptr),
+      end(nullptr), freeLists(MAX_SMALL / GRANULE + 1, nullptr),
+      bigBlocks(nullptr), bytesInUse(0), bytesReserved(0) {}
+
+// destructor, frees every slab and big block
+Arena::~Arena() { release(); }
+
+// @return memory for bytes, aligned for any fundamental type
+void *Arena::allocate(size_t bytes) {
+  size_t size = (bytes + GRANULE - 1) / GRANULE * GRANULE;
+  if (size == 0) {
+    size = GRANULE;
+  }
+  bytesInUse += size;
+  if (size > MAX_SMALL) {
+    // big blocks get their own allocation, linked so release finds them
+    BigBlock *block =
+        static_cast<BigBlock *>(::operator new(sizeof(BigBlock) + size));
+    block->prev = nullptr;
+    block->next = bigBlocks;
+    if (bigBlocks != nullptr) {
+      bigBlocks->prev = block;
+    }
+    bigBlocks = block;
+    bytesReserved += sizeof(BigBlock) + size;
+    return block + 1;
+  }
+  void *&freeList = freeLists[size / GRANULE];
+  if (freeList != nullptr) {
+    void *block = freeList;
+    freeList = *static_cast<void **>(block);
+    return block;
+  }
+  if (next == nullptr || static_cast<size_t>(end - next) < size) {
+    next = static_cast<char *>(::operator new(slabSize));
+    end = next + slabSize;
+    slabs.push_back(next);
+    bytesReserved += slabSize;
+  }
+  void *block = next;
+  next += size;
+  return block;
+}
+
+// give back a block returned by allocate(bytes)
+// small blocks go on the free list for their size, big blocks are freed
+void Arena::deallocate(void *block, size_t bytes) {
+  size_t size = (bytes + GRANULE - 1) / GRANULE * GRANULE;
+  if (size == 0) {
+    size = GRANULE;
+  }
+  bytesInUse -= size;
+  if (size > MAX_SMALL) {
+    BigBlock *big = static_cast<BigBlock *>(block) - 1;
+    if (big->prev != nullptr) {
+      big->prev->next = big->next;
+    } else {
+      bigBlocks = big->next;
+    }
+    if (big->next != nullptr) {
+      big->next->prev = big->prev;
+    }
+    bytesReserved -= sizeof(BigBlock) + size;
+    ::operator delete(big);
+    return;
+  }
+  void *&freeList = freeLists[size / GRANULE];
+  *static_cast<void **>(block) = freeList;
+  freeList = block;
+}
+
+// free every block at once, objects in the arena are not destroyed
+void Arena::release() {
+  for (char *slab : slabs) {
+    ::operator delete(slab);
+  }
+  slabs.clear();
+  while (bigBlocks != nullptr) {
+    BigBlock *block = bigBlocks;
+    bigBlocks = block->next;
+    ::operator delete(block);
+  }
+  freeLists.assign(freeLists.size(), nullptr);
+  next = end = nullptr;
+  bytesInUse = 0;
+  bytesReserved = 0;
+}
+
+// @return number of bytes currently handed out
+size_t Arena::used() const { return bytesInUse; }
+
+// @return number of bytes reserved from the system
+size_t Arena::reserved() const { return bytesReserved; }
@@ -0,0 +1,114 @@
+/**
+ * An Arena hands out memory carved from large slabs.
+ * Small blocks that are given back are kept on a free list per size and
+ * reused by later requests of the same size. Blocks larger than a slab
+ * can hold are allocated on their own but still belong to the arena.
+ * Destroying the arena, or calling release, frees everything at once,
+ * so the objects living in it do not have to be destroyed one by one.
+ *
+ * ArenaAllocator adapts an Arena to the standard allocator interface so
+ * containers can place their nodes in it. An ArenaAllocator without an
+ * arena falls back to operator new and delete.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "instrument.h"
+#include <cstddef>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+class Arena {
+private:
+  // every block is a multiple of this size, which keeps blocks aligned
+  static const size_t GRANULE = 16;
+  // blocks up to this size are carved from slabs and recycled
+  static const size_t MAX_SMALL = 512;
+
+  // header in front of a block too big for the slabs
+  struct BigBlock {
+    BigBlock *prev;
+    BigBlock *next;
+    size_t padding[2]; // keeps the block after the header aligned
+  };
+
+  size_t slabSize;
+  vector<char *> slabs;
+  char *next;         // first free byte in the current slab
+  char *end;          // end of the current slab
+  vector<void *> freeLists; // one list per size class
+  BigBlock *bigBlocks;      // doubly linked list of big blocks
+  size_t bytesInUse;
+  size_t bytesReserved;
+
+public:
+  // empty arena, slabs are allocated slabSize bytes at a time
+  explicit Arena(size_t slabSize = 64 * 1024);
+
+  // copy not allowed
+  Arena(const Arena &other) = delete;
+
+  // assignment not allowed
+  Arena &operator=(const Arena &other) = delete;
+
+  /** destructor, frees every slab and big block */
+  ~Arena();
+
+  // @return memory for bytes, aligned for any fundamental type
+  void *allocate(size_t bytes);
+
+  // give back a block returned by allocate(bytes)
+  void deallocate(void *block, size_t bytes);
+
+  // free every block at once, objects in the arena are not destroyed
+  void release();
+
+  // @return number of bytes currently handed out
+  size_t used() const;
+
+  // @return number of bytes reserved from the system
+  size_t reserved() const;
+};
+
+template <typename T> class ArenaAllocator {
+public:
+  typedef T value_type;
+
+  Arena *arena;
+
+  explicit ArenaAllocator(Arena *arena = nullptr) : arena(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+  T *allocate(size_t n) {
+    GRAPH_COUNT(allocations, 1);
+    if (arena == nullptr) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T *>(arena->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T *block, size_t n) {
+    if (arena == nullptr) {
+      ::operator delete(block);
+    } else {
+      arena->deallocate(block, n * sizeof(T));
+    }
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena != b.arena;
+}
+
+#endif // ARENA_H
@@ -0,0 +1,275 @@
+/**
+ * Benchmarks for Graph on synthetic graphs.
+ * Usage: bench [name=value ...]
+ *   generator=er|rmat|grid|chain|star   graph to build (default er)
+ *   scale=N      about 2^N vertices (default 14)
+ *   degree=N     edges per vertex for er and rmat (default 8)
+ *   weight=N     weights are 1..N (default 100)
+ *   directed=0|1 directed graph (default 0, the mst benchmarks need 0)
+ *   queries=N    start vertices timed for each traversal (default 10)
+ *   repeat=N     times the graph is read and built (default 3)
+ *   seed=N       seed for the generator and the start vertices (default 1)
+ *   ops=a,b,...  benchmarks to run (default all): readFile, connect,
+ *                bfs, dfs, dijkstra, deltaStepping, mstPrim, mstKruskal
+ *   threads=N    threads for deltaStepping (default 0, one per core)
+ * Prints one JSON object per line and benchmark with the throughput, the
+ * latency percentiles of single calls and the peak resident set size of
+ * the process so far, so runs can be compared between releases.
+ */
+
+#include "../graph.h"
+#include "generators.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+using namespace std;
+
+namespace {
+// settings from the command line
+struct Settings {
+  string generator = "er";
+  int scale = 14;
+  int degree = 8;
+  int weight = 100;
+  bool directed = false;
+  int queries = 10;
+  int repeat = 3;
+  uint32_t seed = 1;
+  int threads = 0;
+  string ops =
+      "readFile,connect,bfs,dfs,dijkstra,deltaStepping,mstPrim,mstKruskal";
+};
+
+// the graph being measured
+struct Workload {
+  vector<EdgeUpdate> edges;
+  int vertices;
+};
+
+// timings of one benchmark, in seconds per call
+struct Sample {
+  vector<double> seconds;
+  double work = 0; // units of work done by all calls together
+  string unit;     // what one unit of work is
+};
+
+// visitors count what they are shown, so the calls cannot be optimized
+// away
+long long visited = 0;
+
+void countVertex(const string &) { ++visited; }
+
+void countEdge(const string &, const string &, int) { ++visited; }
+
+// @return peak resident set size of this process in kilobytes
+long peakRssKb() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss; // kilobytes on Linux
+}
+
+// @return seconds spent in f()
+template <typename F> double timed(F f) {
+  auto start = chrono::steady_clock::now();
+  f();
+  chrono::duration<double> spent = chrono::steady_clock::now() - start;
+  return spent.count();
+}
+
+// @return the p-th percentile of sorted values, nearest rank
+double percentile(const vector<double> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t rank = static_cast<size_t>(p / 100 * sorted.size() + 0.5);
+  return sorted[min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+}
+
+// print one benchmark as a line of JSON
+void report(const Settings &settings, const Workload &workload,
+            const string &op, Sample sample) {
+  sort(sample.seconds.begin(), sample.seconds.end());
+  double total = 0;
+  for (double s : sample.seconds) {
+    total += s;
+  }
+  ostringstream out;
+  out << "{\"op\":\"" << op << "\",\"generator\":\"" << settings.generator
+      << "\",\"scale\":" << settings.scale
+      << ",\"directed\":" << (settings.directed ? "true" : "false")
+      << ",\"vertices\":" << workload.vertices
+      << ",\"edges\":" << workload.edges.size()
+      << ",\"calls\":" << sample.seconds.size()
+      << ",\"throughput\":" << (total > 0 ? sample.work / total : 0)
+      << ",\"unit\":\"" << sample.unit << "/s\""
+      << ",\"p50_us\":" << percentile(sample.seconds, 50) * 1e6
+      << ",\"p90_us\":" << percentile(sample.seconds, 90) * 1e6
+      << ",\"p99_us\":" << percentile(sample.seconds, 99) * 1e6
+      << ",\"max_us\":" << percentile(sample.seconds, 100) * 1e6
+      << ",\"peak_rss_kb\":" << peakRssKb() << "}";
+  cout << out.str() << endl;
+}
+
+// @return the edges of the graph named in settings
+Workload generate(const Settings &settings) {
+  Workload workload;
+  long long n = 1LL << settings.scale;
+  long long m = n * settings.degree;
+  if (settings.generator == "rmat") {
+    workload.edges = rmat(settings.scale, m, 0.57, 0.19, 0.19,
+                          settings.weight, settings.seed);
+  } else if (settings.generator == "grid") {
+    int side = 1 << (settings.scale / 2);
+    workload.edges = grid(side, n / side, settings.weight, settings.seed);
+  } else if (settings.generator == "chain") {
+    workload.edges = chain(n);
+  } else if (settings.generator == "star") {
+    workload.edges = star(n, settings.weight, settings.seed);
+  } else {
+    workload.edges = erdosRenyi(n, m, settings.weight, settings.seed);
+  }
+  workload.vertices = n;
+  return workload;
+}
+
+// @return settings from name=value arguments, exits on a bad argument
+Settings parse(int argc, char *argv[]) {
+  Settings settings;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    size_t eq = arg.find('=');
+    string name = arg.substr(0, eq);
+    string value = eq == string::npos ? "" : arg.substr(eq + 1);
+    if (name == "generator") {
+      settings.generator = value;
+    } else if (name == "scale") {
+      settings.scale = atoi(value.c_str());
+    } else if (name == "degree") {
+      settings.degree = atoi(value.c_str());
+    } else if (name == "weight") {
+      settings.weight = max(1, atoi(value.c_str()));
+    } else if (name == "directed") {
+      settings.directed = value == "1" || value == "true";
+    } else if (name == "queries") {
+      settings.queries = max(1, atoi(value.c_str()));
+    } else if (name == "repeat") {
+      settings.repeat = max(1, atoi(value.c_str()));
+    } else if (name == "seed") {
+      settings.seed = strtoul(value.c_str(), nullptr, 10);
+    } else if (name == "threads") {
+      settings.threads = atoi(value.c_str());
+    } else if (name == "ops") {
+      settings.ops = value;
+    } else {
+      cerr << "unknown argument " << arg << endl;
+      exit(1);
+    }
+  }
+  return settings;
+}
+
+// @return true if op is in the comma separated list ops
+bool selected(const string &ops, const string &op) {
+  return ("," + ops + ",").find("," + op + ",") != string::npos;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  Settings settings = parse(argc, argv);
+  Workload workload = generate(settings);
+  const string &ops = settings.ops;
+
+  if (selected(ops, "readFile")) {
+    string filename = "bench_graph_" + to_string(settings.seed) + ".txt";
+    if (!writeEdgeFile(filename, workload.edges)) {
+      cerr << "cannot write " << filename << endl;
+      return 1;
+    }
+    Sample sample;
+    sample.unit = "edges";
+    for (int r = 0; r < settings.repeat; ++r) {
+      Graph g(settings.directed);
+      sample.seconds.push_back(timed([&]() { g.readFile(filename); }));
+      sample.work += workload.edges.size();
+    }
+    remove(filename.c_str());
+    report(settings, workload, "readFile", sample);
+  }
+
+  if (selected(ops, "connect")) {
+    // every call is timed on its own for the percentiles, the clock
+    // costs tens of nanoseconds per call
+    Sample sample;
+    sample.unit = "edges";
+    for (int r = 0; r < settings.repeat; ++r) {
+      Graph g(settings.directed);
+      for (auto const &edge : workload.edges) {
+        sample.seconds.push_back(timed(
+            [&]() { g.connect(edge.from, edge.to, edge.weight); }));
+      }
+      sample.work += workload.edges.size();
+    }
+    report(settings, workload, "connect", sample);
+  }
+
+  Graph graph(settings.directed);
+  graph.connectBatch(workload.edges);
+  workload.vertices = graph.verticesSize();
+  if (workload.vertices == 0) {
+    return 0;
+  }
+  // start vertices for the traversals, the same for every benchmark
+  mt19937 random(settings.seed);
+  vector<VertexId> starts;
+  for (int q = 0; q < settings.queries; ++q) {
+    starts.push_back(randomBelow(random, workload.vertices));
+  }
+  // run one traversal from every start vertex
+  auto traversal = [&](const string &op, const string &unit,
+                       void run(Graph &, VertexId)) {
+    if (!selected(ops, op)) {
+      return;
+    }
+    Sample sample;
+    sample.unit = unit;
+    for (VertexId start : starts) {
+      visited = 0;
+      sample.seconds.push_back(timed([&]() { run(graph, start); }));
+      sample.work += unit == "calls" ? 1 : visited;
+    }
+    report(settings, workload, op, sample);
+  };
+  traversal("bfs", "vertices", [](Graph &g, VertexId start) {
+    g.bfs(start, countVertex);
+  });
+  traversal("dfs", "vertices", [](Graph &g, VertexId start) {
+    g.dfs(start, countVertex);
+  });
+  traversal("dijkstra", "calls", [](Graph &g, VertexId start) {
+    visited += g.dijkstra(start).first.size();
+  });
+  static DijkstraOptions parallel;
+  parallel.parallel = true;
+  parallel.threads = settings.threads;
+  traversal("deltaStepping", "calls", [](Graph &g, VertexId start) {
+    visited += g.dijkstra(start, parallel).first.size();
+  });
+  if (!settings.directed) {
+    traversal("mstPrim", "edges", [](Graph &g, VertexId start) {
+      g.mstPrim(g.label(start), countEdge);
+    });
+    traversal("mstKruskal", "edges", [](Graph &g, VertexId start) {
+      g.mstKruskal(g.label(start), countEdge);
+    });
+  }
+  return 0;
+}
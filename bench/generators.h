@@ -0,0 +1,132 @@
+/**
+ * Reproducible synthetic graphs for the benchmarks.
+ * Every generator returns an edge list with labels "v0", "v1", ... and
+ * depends only on its arguments: random numbers come straight from
+ * mt19937, which is fully specified by the standard, and never pass
+ * through a distribution, whose output differs between libraries.
+ * The lists can be given to Graph::connectBatch or written as a text
+ * file with writeEdgeFile. They may contain self-loops and duplicates,
+ * which the graph rejects like it does in a file.
+ */
+
+#ifndef GENERATORS_H
+#define GENERATORS_H
+
+#include "../graph.h"
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// @return label of vertex i
+inline string vertexLabel(long long i) { return "v" + to_string(i); }
+
+// @return random number in [0, bound)
+inline uint32_t randomBelow(mt19937 &random, uint32_t bound) {
+  return static_cast<uint32_t>((static_cast<uint64_t>(random()) * bound) >>
+                               32);
+}
+
+// Erdos-Renyi G(n, m): m edges with both ends chosen uniformly
+inline vector<EdgeUpdate> erdosRenyi(int n, long long m, int maxWeight,
+                                     uint32_t seed) {
+  mt19937 random(seed);
+  vector<EdgeUpdate> edges;
+  edges.reserve(m);
+  for (long long i = 0; i < m; ++i) {
+    uint32_t from = randomBelow(random, n);
+    uint32_t to = randomBelow(random, n);
+    int weight = 1 + randomBelow(random, maxWeight);
+    edges.push_back({vertexLabel(from), vertexLabel(to), weight});
+  }
+  return edges;
+}
+
+// R-MAT with 2^scale vertices and m edges: each edge picks one quadrant
+// of the adjacency matrix per bit with probabilities a, b, c and
+// 1 - a - b - c, which gives the skewed degrees of social and web graphs
+// (Graph500 uses a = 0.57, b = 0.19, c = 0.19)
+inline vector<EdgeUpdate> rmat(int scale, long long m, double a, double b,
+                               double c, int maxWeight, uint32_t seed) {
+  mt19937 random(seed);
+  const double UNIT = 4294967296.0; // 2^32
+  uint64_t ab = static_cast<uint64_t>((a + b) * UNIT);
+  uint64_t aOnly = static_cast<uint64_t>(a * UNIT);
+  uint64_t abc = static_cast<uint64_t>((a + b + c) * UNIT);
+  vector<EdgeUpdate> edges;
+  edges.reserve(m);
+  for (long long i = 0; i < m; ++i) {
+    long long from = 0;
+    long long to = 0;
+    for (int bit = 0; bit < scale; ++bit) {
+      uint64_t pick = random();
+      from = from * 2 + (pick >= ab ? 1 : 0);
+      to = to * 2 + ((pick >= aOnly && pick < ab) || pick >= abc ? 1 : 0);
+    }
+    int weight = 1 + randomBelow(random, maxWeight);
+    edges.push_back({vertexLabel(from), vertexLabel(to), weight});
+  }
+  return edges;
+}
+
+// rows x columns grid with random weights, road networks look like this:
+// low degree, large diameter, long shortest paths
+inline vector<EdgeUpdate> grid(int rows, int columns, int maxWeight,
+                               uint32_t seed) {
+  mt19937 random(seed);
+  vector<EdgeUpdate> edges;
+  for (int r = 0; r < rows; ++r) {
+    for (int c = 0; c < columns; ++c) {
+      long long v = static_cast<long long>(r) * columns + c;
+      if (c + 1 < columns) {
+        edges.push_back({vertexLabel(v), vertexLabel(v + 1),
+                         1 + static_cast<int>(randomBelow(random, maxWeight))});
+      }
+      if (r + 1 < rows) {
+        edges.push_back({vertexLabel(v), vertexLabel(v + columns),
+                         1 + static_cast<int>(randomBelow(random, maxWeight))});
+      }
+    }
+  }
+  return edges;
+}
+
+// v0 -> v1 -> ... -> v(n-1), the deepest graph a traversal can meet
+inline vector<EdgeUpdate> chain(int n) {
+  vector<EdgeUpdate> edges;
+  for (int i = 0; i + 1 < n; ++i) {
+    edges.push_back({vertexLabel(i), vertexLabel(i + 1), 1});
+  }
+  return edges;
+}
+
+// v0 connected to every other vertex, one vertex with a huge degree
+inline vector<EdgeUpdate> star(int n, int maxWeight, uint32_t seed) {
+  mt19937 random(seed);
+  vector<EdgeUpdate> edges;
+  for (int i = 1; i < n; ++i) {
+    edges.push_back({vertexLabel(0), vertexLabel(i),
+                     1 + static_cast<int>(randomBelow(random, maxWeight))});
+  }
+  return edges;
+}
+
+// write edges in the format read by Graph::readFile
+// @return true if file successfully written
+inline bool writeEdgeFile(const string &filename,
+                          const vector<EdgeUpdate> &edges) {
+  ofstream file(filename);
+  if (!file.is_open()) {
+    return false;
+  }
+  file << edges.size() << "\n";
+  for (auto const &edge : edges) {
+    file << edge.from << " " << edge.to << " " << edge.weight << "\n";
+  }
+  return static_cast<bool>(file);
+}
+
+#endif // GENERATORS_H
@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# Build the benchmarks with optimization and run them on every generator
+# Run from the repository root as `./bench/runbench.sh > results.jsonl`
+# Extra arguments are passed to every run, e.g. `./bench/runbench.sh scale=16`
+# Each line of output is one JSON object, see bench/bench.cpp
+
+cd "$(dirname "$0")/.." || exit 1
+
+SOURCES=$(ls *.cpp | grep -v -e '^main.cpp$' -e 'test.cpp$')
+g++ -O2 -DNDEBUG -std=c++11 -pthread -o bench/bench bench/bench.cpp \
+  $SOURCES || exit 1
+
+for GENERATOR in er rmat grid chain star; do
+  ./bench/bench generator=$GENERATOR "$@" || exit 1
+done
@@ -0,0 +1,166 @@
+/**
+ * Direction-optimizing breadth-first search over CSR arrays.
+ * Each level is expanded either top-down, where the frontier looks at
+ * its out-edges, or bottom-up, where every unvisited vertex looks at its
+ * in-edges for a parent in the frontier and stops at the first one.
+ * Bottom-up wins once the frontier is large, so the search switches
+ * between the two using the heuristic of Beamer, Asanovic and Patterson.
+ * Visited vertices and bottom-up frontiers are bitmaps, and each level
+ * is split across threads. Hop distances do not depend on the number of
+ * threads; when several parents are one hop closer, which one is
+ * recorded may.
+ */
+
+#ifndef BFS_H
+#define BFS_H
+
+#include "parallel.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// one direction of a CSR adjacency: the neighbours of vertex i are
+// targets[offsets[i]] .. targets[offsets[i + 1] - 1]
+struct CsrArrays {
+  int size;
+  const int *offsets;
+  const int *targets;
+};
+
+// result of a level breadth-first search, indexed by vertex id
+struct BfsResult {
+  vector<int> distance; // hops from the start vertex, -1 if not reachable
+  vector<int> parent;   // previous vertex on a shortest hop path, -1 for
+                        // the start vertex and for unreachable vertices
+};
+
+// breadth-first search from start, out holds the out-edges and in the
+// in-edges (the same arrays for undirected graphs)
+inline BfsResult levelBfs(const CsrArrays &out, const CsrArrays &in,
+                          int start, int threads) {
+  // switch to bottom-up when the frontier has more than 1/ALPHA of the
+  // unexplored edges, back to top-down when it has under 1/BETA of the
+  // vertices and is shrinking
+  const long long ALPHA = 15;
+  const long long BETA = 18;
+  // frontiers smaller than this per thread are not worth a thread
+  const int GRAIN = 4096;
+  int n = out.size;
+  int words = (n + 63) / 64;
+  BfsResult result;
+  result.distance.assign(n, -1);
+  result.parent.assign(n, -1);
+  int *distance = result.distance.data();
+  int *parent = result.parent.data();
+  vector<atomic<uint64_t>> visited(words);
+  vector<uint64_t> frontierBits(words);
+  vector<uint64_t> nextBits(words);
+  threads = threadCount(threads);
+  vector<vector<int>> nextLocal(threads);
+  vector<long long> counts(threads);
+
+  vector<int> frontier(1, start);
+  distance[start] = 0;
+  visited[start / 64].store(uint64_t(1) << (start % 64));
+  long long edgesToCheck = out.offsets[n];
+  long long scoutCount = out.offsets[start + 1] - out.offsets[start];
+  int level = 0;
+  while (!frontier.empty()) {
+    if (scoutCount > edgesToCheck / ALPHA) {
+      // bottom-up until the frontier is small and shrinking again
+      fill(frontierBits.begin(), frontierBits.end(), 0);
+      for (int v : frontier) {
+        frontierBits[v / 64] |= uint64_t(1) << (v % 64);
+      }
+      long long awake = frontier.size();
+      long long oldAwake;
+      do {
+        oldAwake = awake;
+        ++level;
+        // each thread owns whole words of the bitmaps
+        parallelFor(threads, words, [&](int begin, int end, int t) {
+          long long found = 0;
+          for (int w = begin; w < end; ++w) {
+            uint64_t seen = visited[w].load(memory_order_relaxed);
+            uint64_t next = 0;
+            for (int b = 0; b < 64 && w * 64 + b < n; ++b) {
+              if ((seen >> b & 1) != 0) {
+                continue;
+              }
+              int v = w * 64 + b;
+              for (int i = in.offsets[v]; i < in.offsets[v + 1]; ++i) {
+                int u = in.targets[i];
+                if ((frontierBits[u / 64] >> (u % 64) & 1) != 0) {
+                  parent[v] = u;
+                  distance[v] = level;
+                  next |= uint64_t(1) << b;
+                  ++found;
+                  break;
+                }
+              }
+            }
+            nextBits[w] = next;
+            visited[w].store(seen | next, memory_order_relaxed);
+          }
+          counts[t] = found;
+        });
+        awake = 0;
+        for (int t = 0; t < threads; ++t) {
+          awake += counts[t];
+          counts[t] = 0;
+        }
+        frontierBits.swap(nextBits);
+      } while (awake >= oldAwake || awake > n / BETA);
+      frontier.clear();
+      for (int w = 0; w < words; ++w) {
+        for (uint64_t bits = frontierBits[w]; bits != 0; bits &= bits - 1) {
+          int b = 0;
+          while ((bits >> b & 1) == 0) {
+            ++b;
+          }
+          frontier.push_back(w * 64 + b);
+        }
+      }
+      scoutCount = 1;
+    } else {
+      // top-down, threads claim vertices by setting their visited bit
+      edgesToCheck -= scoutCount;
+      ++level;
+      int size = frontier.size();
+      int useThreads = min(threads, 1 + size / GRAIN);
+      parallelFor(useThreads, size, [&](int begin, int end, int t) {
+        vector<int> &next = nextLocal[t];
+        long long scout = 0;
+        for (int f = begin; f < end; ++f) {
+          int u = frontier[f];
+          for (int i = out.offsets[u]; i < out.offsets[u + 1]; ++i) {
+            int v = out.targets[i];
+            uint64_t bit = uint64_t(1) << (v % 64);
+            if ((visited[v / 64].load(memory_order_relaxed) & bit) == 0 &&
+                (visited[v / 64].fetch_or(bit) & bit) == 0) {
+              parent[v] = u;
+              distance[v] = level;
+              next.push_back(v);
+              scout += out.offsets[v + 1] - out.offsets[v];
+            }
+          }
+        }
+        counts[t] = scout;
+      });
+      frontier.clear();
+      scoutCount = 0;
+      for (int t = 0; t < useThreads; ++t) {
+        frontier.insert(frontier.end(), nextLocal[t].begin(),
+                        nextLocal[t].end());
+        nextLocal[t].clear();
+        scoutCount += counts[t];
+        counts[t] = 0;
+      }
+    }
+  }
+  return result;
+}
+
+#endif // BFS_H
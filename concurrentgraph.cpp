@@ -0,0 +1,116 @@
+#include "concurrentgraph.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+// register with graph, which must outlive the reader
+ConcurrentGraph::Reader::Reader(ConcurrentGraph &graph)
+    : active(0), graph(graph), held(0) {
+  lock_guard<mutex> guard(graph.readersLock);
+  graph.readers.push_back(this);
+}
+
+/** destructor, every snapshot taken must have been let go */
+ConcurrentGraph::Reader::~Reader() {
+  assert(held == 0 && "snapshot outlives its reader");
+  lock_guard<mutex> guard(graph.readersLock);
+  graph.readers.erase(find(graph.readers.begin(), graph.readers.end(), this));
+}
+
+// @return the latest published version
+// the epoch is announced before the pointer is loaded, so a writer that
+// replaces the pointer afterwards sees the epoch and keeps the version
+ConcurrentGraph::Snapshot ConcurrentGraph::Reader::snapshot() {
+  if (held++ == 0) {
+    active.store(graph.epoch.load());
+  }
+  return Snapshot(this, graph.current.load());
+}
+
+// let go of one snapshot, leave the epoch after the last one
+void ConcurrentGraph::Reader::release() {
+  if (--held == 0) {
+    active.store(0);
+  }
+}
+
+// hold graph for reader
+ConcurrentGraph::Snapshot::Snapshot(Reader *reader, const FrozenGraph *graph)
+    : reader(reader), graph(graph) {}
+
+// move allowed, the version changes owner
+ConcurrentGraph::Snapshot::Snapshot(Snapshot &&other) noexcept
+    : reader(other.reader), graph(other.graph) {
+  other.reader = nullptr;
+}
+
+/** destructor, lets go of the version */
+ConcurrentGraph::Snapshot::~Snapshot() {
+  if (reader != nullptr) {
+    reader->release();
+  }
+}
+
+// constructor, empty graph and an empty first snapshot
+ConcurrentGraph::ConcurrentGraph(bool directionalEdges)
+    : writer(directionalEdges), current(nullptr), epoch(1), versions(0) {
+  publish();
+}
+
+/** destructor, frees every snapshot, no reader may be left */
+ConcurrentGraph::~ConcurrentGraph() {
+  assert(readers.empty() && "reader outlives its graph");
+  delete current.load();
+}
+
+// freeze the writer graph and make it the current snapshot
+// the old snapshot is retired in the epoch it was replaced in
+void ConcurrentGraph::publish() {
+  const FrozenGraph *next = new FrozenGraph(writer);
+  const FrozenGraph *old = current.exchange(next);
+  if (old != nullptr) {
+    retired.push_back(Retired{unique_ptr<const FrozenGraph>(old),
+                              epoch.fetch_add(1)});
+  }
+  ++versions;
+  reclaim();
+}
+
+// free the retired snapshots no reader can still hold
+// a reader that got one entered in or before the epoch it was retired in
+void ConcurrentGraph::reclaim() {
+  uint64_t oldest = UINT64_MAX;
+  {
+    lock_guard<mutex> guard(readersLock);
+    for (Reader *reader : readers) {
+      uint64_t entered = reader->active.load();
+      if (entered != 0) {
+        oldest = min(oldest, entered);
+      }
+    }
+  }
+  retired.erase(remove_if(retired.begin(), retired.end(),
+                          [oldest](const Retired &old) {
+                            return old.epoch < oldest;
+                          }),
+                retired.end());
+}
+
+// @return number of versions published
+long long ConcurrentGraph::version() const { return versions.load(); }
+
+// add edges and publish the result
+vector<bool> ConcurrentGraph::connectBatch(const vector<EdgeUpdate> &edges) {
+  vector<bool> done;
+  update([&](Graph &graph) { done = graph.connectBatch(edges); });
+  return done;
+}
+
+// remove edges and publish the result
+vector<bool>
+ConcurrentGraph::disconnectBatch(const vector<EdgeUpdate> &edges) {
+  vector<bool> done;
+  update([&](Graph &graph) { done = graph.disconnectBatch(edges); });
+  return done;
+}
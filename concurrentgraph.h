@@ -0,0 +1,167 @@
+/**
+ * A ConcurrentGraph lets many threads read a graph while others change it.
+ * Writers change a private Graph one at a time under a lock and then
+ * publish a FrozenGraph snapshot of it. Readers take the latest published
+ * snapshot and run any query on it without locks.
+ *
+ * Snapshots are reclaimed by epochs (read-copy-update). Every reading
+ * thread registers a Reader, which holds the epoch it entered in on a
+ * cache line of its own. Taking a snapshot stores that epoch and loads
+ * the current pointer, and letting go of it clears the epoch: nothing is
+ * locked and no shared counter is written, so reads scale with the
+ * number of cores while updates keep coming. A writer retires the
+ * snapshot it replaces with the epoch it was replaced in, and frees it
+ * once every Reader has left that epoch. A snapshot never changes while
+ * it is held, even after newer versions have been published.
+ *
+ * Publishing freezes the whole graph, O(V + E) for every batch, so
+ * writers should group their changes into batches rather than publish one
+ * edge at a time. Readers, and the snapshots they hold, must not outlive
+ * the ConcurrentGraph.
+ */
+
+#ifndef CONCURRENTGRAPH_H
+#define CONCURRENTGRAPH_H
+
+#include "frozengraph.h"
+#include "graph.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+class ConcurrentGraph {
+public:
+  class Snapshot;
+
+  // a thread reading the graph, each reading thread needs its own
+  class Reader {
+    friend class ConcurrentGraph;
+    friend class Snapshot;
+
+  private:
+    // epoch this reader entered in, 0 while it holds no snapshot
+    // alone on its cache line, only its thread writes it
+    alignas(64) atomic<uint64_t> active;
+    ConcurrentGraph &graph;
+    // number of snapshots held, only touched by the reading thread
+    int held;
+
+    // let go of one snapshot, leave the epoch after the last one
+    void release();
+
+  public:
+    // register with graph, which must outlive the reader
+    explicit Reader(ConcurrentGraph &graph);
+
+    // copy not allowed
+    Reader(const Reader &other) = delete;
+
+    // assignment not allowed
+    Reader &operator=(const Reader &other) = delete;
+
+    /** destructor, every snapshot taken must have been let go */
+    ~Reader();
+
+    // @return the latest published version, never blocked by writers
+    // it stays valid until the Snapshot is destroyed
+    Snapshot snapshot();
+  };
+
+  // a published version held by a Reader, move only
+  class Snapshot {
+    friend class Reader;
+
+  private:
+    Reader *reader;
+    const FrozenGraph *graph;
+
+    // hold graph for reader
+    Snapshot(Reader *reader, const FrozenGraph *graph);
+
+  public:
+    // move allowed, the version changes owner
+    Snapshot(Snapshot &&other) noexcept;
+
+    // copy not allowed
+    Snapshot(const Snapshot &other) = delete;
+
+    // assignment not allowed
+    Snapshot &operator=(const Snapshot &other) = delete;
+
+    /** destructor, lets go of the version */
+    ~Snapshot();
+
+    // @return the version held
+    const FrozenGraph &operator*() const { return *graph; }
+
+    // @return the version held
+    const FrozenGraph *operator->() const { return graph; }
+  };
+
+private:
+  // a replaced snapshot and the epoch it was replaced in
+  struct Retired {
+    unique_ptr<const FrozenGraph> graph;
+    uint64_t epoch;
+  };
+
+  // the graph writers change, only touched while holding writeLock
+  Graph writer;
+  mutex writeLock;
+  // latest published snapshot, owned by the ConcurrentGraph
+  atomic<const FrozenGraph *> current;
+  // incremented every time a snapshot is replaced, starts at 1
+  atomic<uint64_t> epoch;
+  // number of snapshots published so far
+  atomic<long long> versions;
+  // replaced snapshots not freed yet, guarded by writeLock
+  vector<Retired> retired;
+  // registered readers, only locked to register and by writers
+  vector<Reader *> readers;
+  mutex readersLock;
+
+  // freeze the writer graph and make it the current snapshot
+  void publish();
+
+  // free the retired snapshots no reader can still hold
+  void reclaim();
+
+public:
+  // constructor, empty graph and an empty first snapshot
+  explicit ConcurrentGraph(bool directionalEdges = true);
+
+  // copy not allowed
+  ConcurrentGraph(const ConcurrentGraph &other) = delete;
+
+  // assignment not allowed
+  ConcurrentGraph &operator=(const ConcurrentGraph &other) = delete;
+
+  /** destructor, frees every snapshot, no reader may be left */
+  ~ConcurrentGraph();
+
+  // @return number of versions published, the empty graph is version 1
+  // safe to call from any thread and never blocked by writers
+  long long version() const;
+
+  // add edges with Graph::connectBatch and publish the result
+  // @return for each edge, true if it was connected
+  vector<bool> connectBatch(const vector<EdgeUpdate> &edges);
+
+  // remove edges with Graph::disconnectBatch and publish the result
+  // @return for each edge, true if it was deleted
+  vector<bool> disconnectBatch(const vector<EdgeUpdate> &edges);
+
+  // call change(Graph &) with the writer graph, then publish the result
+  // as one version, other writers wait until it is done
+  template <typename F> void update(F change) {
+    lock_guard<mutex> guard(writeLock);
+    change(writer);
+    publish();
+  }
+};
+
+#endif // CONCURRENTGRAPH_H
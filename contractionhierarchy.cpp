@@ -0,0 +1,392 @@
+#include "contractionhierarchy.h"
+#include "graph.h"
+#include "heap.h"
+#include "weight.h"
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+// a witness search gives up after settling this many vertices and adds
+// the shortcut, which is never wrong, only wasteful
+const int WITNESS_SETTLE_LIMIT = 200;
+
+// the graph while it is being contracted
+// every vertex keeps its out-arcs and in-arcs to vertices that are not
+// contracted yet, as (other end, weight, middle) triples
+// sums are taken with extendPath, a path that would reach INT_MAX is not
+// taken, as in Graph::dijkstra, and gets no shortcut
+struct Contractor {
+  struct Arc {
+    VertexId other;
+    int weight;
+    VertexId middle;
+  };
+
+  vector<vector<Arc>> out;
+  vector<vector<Arc>> in;
+  // contracted neighbours of each vertex, spreads contraction evenly
+  vector<int> deleted;
+  // one more than the highest level among contracted neighbours, keeps
+  // the hierarchy shallow
+  vector<int> level;
+  // witness search memory, reset through touched after every search
+  vector<int> dist;
+  vector<VertexId> touched;
+  BinaryHeap<int> heap;
+
+  explicit Contractor(int n)
+      : out(n), in(n), deleted(n, 0), level(n, 0),
+        dist(n, INT_MAX), heap(n) {}
+
+  // add u -> w, or lower its weight if it is already there
+  void addArc(VertexId u, VertexId w, int weight, VertexId middle) {
+    for (Arc &arc : out[u]) {
+      if (arc.other == w) {
+        if (weight < arc.weight) {
+          arc.weight = weight;
+          arc.middle = middle;
+          for (Arc &back : in[w]) {
+            if (back.other == u) {
+              back.weight = weight;
+              back.middle = middle;
+            }
+          }
+        }
+        return;
+      }
+    }
+    out[u].push_back(Arc{w, weight, middle});
+    in[w].push_back(Arc{u, weight, middle});
+  }
+
+  // dijkstra from source that ignores skip, stops past limit
+  void witnessSearch(VertexId source, VertexId skip, int limit) {
+    for (VertexId v : touched) {
+      dist[v] = INT_MAX;
+    }
+    touched.clear();
+    heap.clear();
+    dist[source] = 0;
+    touched.push_back(source);
+    heap.push(source, 0);
+    for (int settled = 0; !heap.empty() && settled < WITNESS_SETTLE_LIMIT;
+         ++settled) {
+      if (heap.topKey() > limit) {
+        break;
+      }
+      VertexId curr = heap.pop();
+      for (const Arc &arc : out[curr]) {
+        if (arc.other == skip) {
+          continue;
+        }
+        int next;
+        if (!extendPath(dist[curr], arc.weight, next)) {
+          continue;
+        }
+        if (next < dist[arc.other]) {
+          if (dist[arc.other] == INT_MAX) {
+            touched.push_back(arc.other);
+          }
+          dist[arc.other] = next;
+          heap.push(arc.other, next);
+        }
+      }
+    }
+  }
+
+  // shortcuts needed to contract v, added unless simulate is true
+  // @return number of shortcuts
+  int contract(VertexId v, bool simulate) {
+    int shortcuts = 0;
+    for (const Arc &first : in[v]) {
+      VertexId u = first.other;
+      int limit = -1;
+      for (const Arc &second : out[v]) {
+        int through;
+        if (second.other != u &&
+            extendPath(first.weight, second.weight, through)) {
+          limit = max(limit, through);
+        }
+      }
+      if (limit == -1) {
+        continue; // v leads nowhere but back to u
+      }
+      witnessSearch(u, v, limit);
+      for (const Arc &second : out[v]) {
+        VertexId w = second.other;
+        int through;
+        if (w == u || !extendPath(first.weight, second.weight, through) ||
+            dist[w] <= through) {
+          continue;
+        }
+        ++shortcuts;
+        if (!simulate) {
+          addArc(u, w, through, v);
+        }
+      }
+    }
+    return shortcuts;
+  }
+
+  // @return how much contracting v now would cost, lower goes first
+  int priority(VertexId v) {
+    int degree = in[v].size() + out[v].size();
+    return 2 * (contract(v, true) - degree) + deleted[v] + level[v];
+  }
+
+  // remove v from its neighbours' arc lists
+  void detach(VertexId v) {
+    auto forget = [this, v](vector<Arc> &arcs, VertexId w) {
+      arcs.erase(remove_if(arcs.begin(), arcs.end(),
+                           [v](const Arc &a) { return a.other == v; }),
+                 arcs.end());
+      ++deleted[w];
+      level[w] = max(level[w], level[v] + 1);
+    };
+    for (const Arc &arc : out[v]) {
+      forget(in[arc.other], arc.other);
+    }
+    for (const Arc &arc : in[v]) {
+      forget(out[arc.other], arc.other);
+    }
+  }
+};
+} // namespace
+
+// working memory of one query, one copy per direction
+// entries are reset through touched, so a query costs what it visits
+struct ContractionHierarchy::Scratch {
+  vector<int> dist[2];
+  vector<VertexId> parent[2]; // previous vertex in the search
+  vector<VertexId> via[2];    // middle of the arc from parent
+  vector<VertexId> touched;
+  BinaryHeap<int> heap[2];
+
+  explicit Scratch(int n) : heap{BinaryHeap<int>(n), BinaryHeap<int>(n)} {
+    for (int side = 0; side < 2; ++side) {
+      dist[side].assign(n, INT_MAX);
+      parent[side].assign(n, -1);
+      via[side].assign(n, -1);
+    }
+  }
+};
+
+// contract every vertex of graph
+// vertices are taken in order of twice the edge difference (shortcuts
+// added minus edges removed) plus contracted neighbours plus level
+// priorities are only brought up to date when a vertex is popped: one
+// whose priority got worse since it was queued is queued again instead
+ContractionHierarchy::ContractionHierarchy(const Graph &graph)
+    : shortcutCount(0) {
+  int n = graph.verticesSize();
+  for (VertexId v = 0; v < n; ++v) {
+    labels.intern(graph.label(v));
+  }
+  Contractor contractor(n);
+  for (VertexId v = 0; v < n; ++v) {
+    graph.forEachEdge(v, [&contractor, v](VertexId to, int weight) {
+      contractor.addArc(v, to, weight, -1);
+    });
+  }
+  BinaryHeap<int> queue(n);
+  for (VertexId v = 0; v < n; ++v) {
+    queue.push(v, contractor.priority(v));
+  }
+  rank.assign(n, -1);
+  vector<vector<Arc>> upward(n);
+  vector<vector<Arc>> downward(n);
+  int order = 0;
+  while (!queue.empty()) {
+    VertexId v = queue.pop();
+    int now = contractor.priority(v);
+    if (!queue.empty() && now > queue.topKey()) {
+      queue.push(v, now);
+      continue;
+    }
+    rank[v] = order++;
+    // the arcs left at v all lead to vertices contracted later
+    for (const Contractor::Arc &arc : contractor.out[v]) {
+      upward[v].push_back(Arc{arc.other, arc.weight, arc.middle});
+    }
+    for (const Contractor::Arc &arc : contractor.in[v]) {
+      downward[v].push_back(Arc{arc.other, arc.weight, arc.middle});
+    }
+    shortcutCount += contractor.contract(v, false);
+    contractor.detach(v);
+  }
+  auto flatten = [](const vector<vector<Arc>> &rows, Csr &csr) {
+    csr.offsets.push_back(0);
+    for (auto const &row : rows) {
+      csr.arcs.insert(csr.arcs.end(), row.begin(), row.end());
+      csr.offsets.push_back(csr.arcs.size());
+    }
+  };
+  flatten(upward, up);
+  flatten(downward, down);
+}
+
+/** destructor */
+ContractionHierarchy::~ContractionHierarchy() = default;
+
+// @return total number of vertices
+int ContractionHierarchy::verticesSize() const { return rank.size(); }
+
+// @return number of shortcut edges added by preprocessing
+int ContractionHierarchy::shortcutsSize() const { return shortcutCount; }
+
+// @return true if vertex is in the hierarchy
+bool ContractionHierarchy::contains(const string &label) const {
+  return labels.find(label) != -1;
+}
+
+// @return the middle vertex of the arc between row and other in csr
+VertexId ContractionHierarchy::middleOf(const Csr &csr, VertexId row,
+                                        VertexId other) const {
+  for (int i = csr.offsets[row]; i < csr.offsets[row + 1]; ++i) {
+    if (csr.arcs[i].to == other) {
+      return csr.arcs[i].middle;
+    }
+  }
+  return -1;
+}
+
+// append the original vertices after from on the arc from -> to
+// a shortcut from -> to through m was made when m was contracted, so
+// from -> m is stored in down at m and m -> to in up at m
+void ContractionHierarchy::unpack(VertexId from, VertexId to,
+                                  VertexId middle,
+                                  vector<VertexId> &path) const {
+  struct Pending {
+    VertexId from;
+    VertexId to;
+    VertexId middle;
+  };
+  vector<Pending> stack(1, Pending{from, to, middle});
+  while (!stack.empty()) {
+    Pending arc = stack.back();
+    stack.pop_back();
+    if (arc.middle == -1) {
+      path.push_back(arc.to);
+      continue;
+    }
+    VertexId m = arc.middle;
+    // the first half goes on top so it is unpacked first
+    stack.push_back(Pending{m, arc.to, middleOf(up, m, arc.to)});
+    stack.push_back(Pending{arc.from, m, middleOf(down, m, arc.from)});
+  }
+}
+
+// shortest path between two vertices
+pair<int, vector<string>>
+ContractionHierarchy::shortestPath(const string &from,
+                                   const string &to) const {
+  vector<string> path;
+  pair<int, vector<VertexId>> found =
+      shortestPath(labels.find(from), labels.find(to));
+  for (VertexId v : found.second) {
+    path.push_back(labels.label(v));
+  }
+  return make_pair(found.first, path);
+}
+
+// shortest path between two vertices given by id
+// a forward search from "from" and a backward search from "to" both only
+// climb the hierarchy; a side stops once its smallest key is no better
+// than the best meeting point found so far
+pair<int, vector<VertexId>>
+ContractionHierarchy::shortestPath(VertexId from, VertexId to) const {
+  vector<VertexId> path;
+  int n = verticesSize();
+  if (from < 0 || from >= n || to < 0 || to >= n) {
+    return make_pair(-1, path);
+  }
+  unique_ptr<Scratch> scratch;
+  {
+    lock_guard<mutex> guard(spareLock);
+    if (!spare.empty()) {
+      scratch = move(spare.back());
+      spare.pop_back();
+    }
+  }
+  if (!scratch) {
+    scratch.reset(new Scratch(n));
+  }
+  Scratch &s = *scratch;
+  VertexId start[2] = {from, to};
+  for (int side = 0; side < 2; ++side) {
+    s.dist[side][start[side]] = 0;
+    s.heap[side].push(start[side], 0);
+    s.touched.push_back(start[side]);
+  }
+  int best = INT_MAX;
+  VertexId meet = -1;
+  int side = 1;
+  while (true) {
+    bool open[2];
+    for (int i = 0; i < 2; ++i) {
+      open[i] = !s.heap[i].empty() && s.heap[i].topKey() < best;
+    }
+    if (!open[0] && !open[1]) {
+      break;
+    }
+    // alternate between the sides while both are open
+    side = open[1 - side] ? 1 - side : side;
+    VertexId curr = s.heap[side].pop();
+    int base = s.dist[side][curr];
+    int length;
+    // paths that would reach INT_MAX are not taken, see weight.h
+    if (s.dist[1 - side][curr] != INT_MAX &&
+        extendPath(base, s.dist[1 - side][curr], length) && length < best) {
+      best = length;
+      meet = curr;
+    }
+    const Csr &csr = side == 0 ? up : down;
+    for (int i = csr.offsets[curr]; i < csr.offsets[curr + 1]; ++i) {
+      const Arc &arc = csr.arcs[i];
+      if (extendPath(base, arc.weight, length) &&
+          length < s.dist[side][arc.to]) {
+        if (s.dist[0][arc.to] == INT_MAX && s.dist[1][arc.to] == INT_MAX) {
+          s.touched.push_back(arc.to);
+        }
+        s.dist[side][arc.to] = length;
+        s.parent[side][arc.to] = curr;
+        s.via[side][arc.to] = arc.middle;
+        s.heap[side].push(arc.to, length);
+      }
+    }
+  }
+  if (meet != -1) {
+    // up to the meeting point, then back down towards "to"
+    vector<VertexId> climb;
+    for (VertexId v = meet; v != from; v = s.parent[0][v]) {
+      climb.push_back(v);
+    }
+    path.push_back(from);
+    for (VertexId prev = from; !climb.empty(); climb.pop_back()) {
+      unpack(prev, climb.back(), s.via[0][climb.back()], path);
+      prev = climb.back();
+    }
+    for (VertexId v = meet; v != to; v = s.parent[1][v]) {
+      unpack(v, s.parent[1][v], s.via[1][v], path);
+    }
+  }
+  for (VertexId v : s.touched) {
+    for (int i = 0; i < 2; ++i) {
+      s.dist[i][v] = INT_MAX;
+      s.parent[i][v] = -1;
+      s.via[i][v] = -1;
+    }
+  }
+  s.touched.clear();
+  s.heap[0].clear();
+  s.heap[1].clear();
+  {
+    lock_guard<mutex> guard(spareLock);
+    spare.push_back(move(scratch));
+  }
+  return make_pair(meet == -1 ? -1 : best, path);
+}
@@ -0,0 +1,106 @@
+/**
+ * A ContractionHierarchy answers point-to-point shortest path queries on
+ * a graph that does not change, much faster than dijkstra.
+ * Preprocessing contracts the vertices one at a time, least important
+ * first. Contracting a vertex removes it and adds a shortcut edge
+ * between two of its neighbours whenever the path through it was the
+ * only shortest path between them. Every edge then either goes up or
+ * down in contraction order, and a shortest path can always be found
+ * going up from the source and up from the target until the two searches
+ * meet, so a query settles only a few hundred vertices even on large
+ * road-like graphs. Shortcuts remember the vertex they bypass, so paths
+ * are unpacked back into edges of the original graph.
+ *
+ * The hierarchy is a snapshot: later changes to the graph are not seen.
+ * Vertex ids are the ids of the Graph it was built from.
+ * Edge weights must not be negative.
+ */
+
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include "labeltable.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+template <typename W> class BasicGraph;
+using Graph = BasicGraph<int>;
+
+class ContractionHierarchy {
+private:
+  // an edge of the hierarchy, middle is the vertex a shortcut bypasses,
+  // -1 for an edge of the original graph
+  struct Arc {
+    VertexId to;
+    int weight;
+    VertexId middle;
+  };
+
+  // arcs of every vertex, row i is arcs[offsets[i] .. offsets[i+1])
+  struct Csr {
+    vector<int> offsets;
+    vector<Arc> arcs;
+  };
+
+  // working memory of one query, reused by later queries
+  struct Scratch;
+
+  LabelTable labels;
+  // position of each vertex in contraction order
+  vector<int> rank;
+  // edges u -> w with rank[u] < rank[w], stored at u
+  Csr up;
+  // edges u -> w with rank[u] > rank[w], stored at w with to = u
+  Csr down;
+  int shortcutCount;
+  // scratch not in use by any query
+  mutable vector<unique_ptr<Scratch>> spare;
+  mutable mutex spareLock;
+
+  // @return the middle vertex of the arc from -> to in row of csr
+  VertexId middleOf(const Csr &csr, VertexId row, VertexId other) const;
+
+  // append the original vertices after from on the arc from -> to
+  void unpack(VertexId from, VertexId to, VertexId middle,
+              vector<VertexId> &path) const;
+
+public:
+  // contract every vertex of graph, the graph may be directed or not
+  explicit ContractionHierarchy(const Graph &graph);
+
+  // copy not allowed
+  ContractionHierarchy(const ContractionHierarchy &other) = delete;
+
+  // assignment not allowed
+  ContractionHierarchy &operator=(const ContractionHierarchy &other) = delete;
+
+  /** destructor */
+  ~ContractionHierarchy();
+
+  // @return total number of vertices
+  int verticesSize() const;
+
+  // @return number of shortcut edges added by preprocessing
+  int shortcutsSize() const;
+
+  // @return true if vertex is in the hierarchy
+  bool contains(const string &label) const;
+
+  // shortest path between two vertices, safe to call from many threads
+  // @return a pair of the path cost and the labels on the path from "from"
+  // to "to" inclusive, {-1, {}} if either vertex is missing or unreachable
+  pair<int, vector<string>> shortestPath(const string &from,
+                                         const string &to) const;
+
+  // shortest path between two vertices given by id
+  // @return a pair of the path cost and the ids on the path,
+  // {-1, {}} if either id is not valid or "to" is unreachable
+  pair<int, vector<VertexId>> shortestPath(VertexId from, VertexId to) const;
+};
+
+#endif // CONTRACTIONHIERARCHY_H
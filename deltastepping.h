@@ -0,0 +1,285 @@
+/**
+ * Delta-stepping single source shortest paths (Meyer and Sanders) over
+ * integer vertex ids, the multi-threaded search behind dijkstra and
+ * shortestPath when DijkstraOptions::parallel is set.
+ * Tentative distances are kept in buckets of a fixed width. The lowest
+ * non-empty bucket is settled in rounds: all of its vertices relax their
+ * light edges (weight <= width) at once, which may refill the bucket,
+ * until it stays empty; then the vertices it held relax their heavy
+ * edges, which always land in a later bucket.
+ * Buckets are kept in a ring of at most a few times the average degree,
+ * the number of buckets the default width spans, so a narrow width does
+ * not allocate one bucket for every width step up to the largest weight.
+ * A vertex too far ahead for the ring waits in an overflow heap. The
+ * next bucket settled is the lowest one in the ring or the heap, and
+ * whatever the ring reaches then moves from the heap into the ring.
+ * Every vertex belongs to one thread. A round first lets every thread
+ * turn its share of the bucket into requests for the owners of the
+ * edge targets, then every owner applies the requests for its vertices,
+ * so distances are written without atomics or locks. A distance only
+ * changes to a strictly smaller value, so the previous vertices form a
+ * shortest path tree even with zero weights.
+ * Distances are the same as a sequential Dijkstra. When a vertex has
+ * several shortest paths the previous vertex chosen may differ from it,
+ * it is the same from run to run with the same number of threads.
+ */
+
+#ifndef DELTASTEPPING_H
+#define DELTASTEPPING_H
+
+#include "instrument.h"
+#include "parallel.h"
+#include "weight.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// call f(v) for the share of thread t of the vertices in lists, as if
+// the lists were one list split evenly between threads threads
+template <typename F>
+void forShareOf(const vector<vector<int>> &lists, int t, int threads, F f) {
+  size_t total = 0;
+  for (auto const &list : lists) {
+    total += list.size();
+  }
+  size_t begin = total * t / threads;
+  size_t end = total * (t + 1) / threads;
+  size_t offset = 0;
+  for (auto const &list : lists) {
+    if (offset >= end) {
+      break;
+    }
+    size_t first = max(begin, offset);
+    size_t last = min(end, offset + list.size());
+    for (size_t i = first; i < last; ++i) {
+      f(list[i - offset]);
+    }
+    offset += list.size();
+  }
+}
+
+// shortest paths from source with delta-stepping on threads threads
+// (0 = one per core) and buckets width wide (0 = picked from the weights)
+// stops once target is settled, pass -1 to settle every vertex
+// dist[v] is numeric_limits<Length>::max() and prev[v] is -1 if v
+// was not reached, see weight.h
+template <typename View>
+void deltaSteppingSearch(const View &view, int source, int target,
+                         int threads, double width,
+                         vector<PathLength<typename View::Weight>> &dist,
+                         vector<int> &prev) {
+  typedef typename View::Weight Weight;
+  typedef PathLength<Weight> Length;
+  const Length INF = numeric_limits<Length>::max();
+  int n = view.size();
+  dist.assign(n, INF);
+  prev.assign(n, -1);
+  threads = max(1, min(threadCount(threads), n));
+
+  // the largest weight bounds how far ahead a relaxation can land
+  vector<Weight> maxWeights(threads, 0);
+  vector<long long> edgeCounts(threads, 0);
+  parallelFor(threads, n, [&](int begin, int end, int t) {
+    for (int v = begin; v < end; ++v) {
+      view.forEachEdge(v, [&](int, Weight weight) {
+        maxWeights[t] = max(maxWeights[t], weight);
+        ++edgeCounts[t];
+      });
+    }
+  });
+  Weight maxWeight = *max_element(maxWeights.begin(), maxWeights.end());
+  long long edges = 0;
+  for (long long count : edgeCounts) {
+    edges += count;
+  }
+  if (width <= 0 && edges > 0) {
+    // largest weight over average degree, as Meyer and Sanders suggest
+    width = static_cast<double>(maxWeight) * n / edges;
+  }
+  if (width <= 0) {
+    width = 1;
+  }
+  // buckets are reused round robin, a vertex is never put more than
+  // maxWeight past the bucket being settled, but the ring is capped at a
+  // few times the buckets the default width spans and farther vertices
+  // go to the overflow heap
+  long long ring = max(64LL, 4 * (edges / max(n, 1) + 2));
+  double spanned = maxWeight / width + 2;
+  long long slots =
+      spanned < ring ? static_cast<long long>(spanned) : ring;
+  auto bucketOf = [width](Length d) {
+    return static_cast<long long>(d / width);
+  };
+  int share = (n + threads - 1) / threads;
+  auto owner = [share](int v) { return v / share; };
+
+  struct Request {
+    int to;
+    int from;
+    Length dist;
+  };
+  // buckets[t][slot] holds vertices owned by thread t, an entry is stale
+  // once its vertex moved to a lower bucket
+  vector<vector<vector<int>>> buckets(threads, vector<vector<int>>(slots));
+  // min heaps of (bucket, vertex) of each thread for vertices beyond the
+  // ring, an entry is stale once its vertex moved to a lower bucket
+  typedef pair<long long, int> Far;
+  vector<vector<Far>> overflow(threads);
+  vector<long long> lowest(threads);
+  // vertices of each thread that relax their light edges this round
+  vector<vector<int>> frontier(threads);
+  // vertices of each thread that were in the bucket being settled
+  vector<vector<int>> settled(threads);
+  // requests[from thread][owner of the target]
+  vector<vector<vector<Request>>> requests(
+      threads, vector<vector<Request>>(threads));
+  // distance a vertex last relaxed its light edges from and the last
+  // bucket it was settled in, so nothing is relaxed twice for nothing
+  vector<Length> expanded(n, INF);
+  vector<long long> settledIn(n, -1);
+  vector<long long> relaxed(threads, 0);
+  SpinBarrier barrier(threads);
+  long long current = 0;
+  bool done = false;
+
+  dist[source] = 0;
+  buckets[owner(source)][0].push_back(source);
+  parallelFor(threads, threads, [&](int t, int, int) {
+    long long looked = 0;
+    // turn the light or the heavy edges of u into requests
+    auto relax = [&](int u, bool light) {
+      Length base = dist[u];
+      view.forEachEdge(u, [&](int to, Weight weight) {
+        if ((weight <= width) == light) {
+          ++looked;
+          Length length;
+          if (extendPath(base, weight, length) && length < dist[to]) {
+            requests[t][owner(to)].push_back({to, u, length});
+          }
+        }
+      });
+    };
+    // apply the requests for the vertices of this thread
+    auto apply = [&]() {
+      for (int from = 0; from < threads; ++from) {
+        for (auto const &request : requests[from][t]) {
+          int to = request.to;
+          if (request.dist < dist[to]) {
+            dist[to] = request.dist;
+            prev[to] = request.from;
+            long long b = bucketOf(request.dist);
+            if (b < current + slots) {
+              buckets[t][b % slots].push_back(to);
+            } else {
+              overflow[t].emplace_back(b, to);
+              push_heap(overflow[t].begin(), overflow[t].end(),
+                        greater<Far>());
+            }
+          }
+        }
+        requests[from][t].clear();
+      }
+    };
+    while (!done) {
+      // light edges, until no vertex of the bucket is left to relax
+      while (true) {
+        vector<int> &bucket = buckets[t][current % slots];
+        frontier[t].clear();
+        for (int v : bucket) {
+          if (bucketOf(dist[v]) == current && expanded[v] != dist[v]) {
+            expanded[v] = dist[v];
+            frontier[t].push_back(v);
+            if (settledIn[v] != current) {
+              settledIn[v] = current;
+              settled[t].push_back(v);
+            }
+          }
+        }
+        bucket.clear();
+        barrier.wait();
+        bool empty = true;
+        for (auto const &list : frontier) {
+          empty = empty && list.empty();
+        }
+        if (empty) {
+          break;
+        }
+        forShareOf(frontier, t, threads, [&](int u) { relax(u, true); });
+        barrier.wait();
+        apply();
+        barrier.wait();
+      }
+      // heavy edges, the bucket is settled
+      forShareOf(settled, t, threads, [&](int u) { relax(u, false); });
+      if (t == 0) {
+        for (int o = 0; o < threads; ++o) {
+          GRAPH_COUNT(settled, settled[o].size());
+        }
+      }
+      barrier.wait();
+      settled[t].clear();
+      apply();
+      // lowest bucket waiting in the overflow heap of this thread
+      vector<Far> &heap = overflow[t];
+      auto pop = [&heap]() {
+        pop_heap(heap.begin(), heap.end(), greater<Far>());
+        heap.pop_back();
+      };
+      while (!heap.empty() &&
+             bucketOf(dist[heap.front().second]) < heap.front().first) {
+        pop();
+      }
+      lowest[t] = heap.empty() ? LLONG_MAX : heap.front().first;
+      barrier.wait();
+      if (t == 0) {
+        // every distance below the next bucket is final
+        if (target != -1 && dist[target] != INF &&
+            bucketOf(dist[target]) <= current) {
+          done = true;
+        }
+        // the next bucket is the first one in the ring that is not empty,
+        // unless a bucket waiting in overflow comes before it
+        long long far = *min_element(lowest.begin(), lowest.end());
+        long long limit = min(current + slots, far);
+        long long next = current + 1;
+        while (!done && next < limit) {
+          bool empty = true;
+          for (int o = 0; o < threads; ++o) {
+            empty = empty && buckets[o][next % slots].empty();
+          }
+          if (!empty) {
+            break;
+          }
+          ++next;
+        }
+        if (next == limit) {
+          next = far;
+        }
+        done = done || next == LLONG_MAX;
+        current = next;
+      }
+      barrier.wait();
+      // move what the ring now reaches out of overflow
+      while (!done && !heap.empty() &&
+             heap.front().first < current + slots) {
+        long long b = heap.front().first;
+        int v = heap.front().second;
+        pop();
+        if (bucketOf(dist[v]) == b) {
+          buckets[t][b % slots].push_back(v);
+        }
+      }
+    }
+    relaxed[t] = looked;
+  });
+  for (int t = 0; t < threads; ++t) {
+    GRAPH_COUNT(relaxed, relaxed[t]);
+  }
+}
+
+#endif // DELTASTEPPING_H
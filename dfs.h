@@ -0,0 +1,110 @@
+/**
+ * Depth-first search engine over integer vertex ids.
+ * The search keeps its own stack instead of recursing, so long chains
+ * cannot overflow the call stack. Neighbours are visited in the order
+ * the view's forEachSortedEdge gives them, which for Graph and
+ * FrozenGraph is label order, the same order the recursive dfs used.
+ * Besides the visit order it records, for every vertex, the pre-order
+ * and post-order number, the discovery and finish time (one clock tick
+ * per entry and per exit) and the parent in the search tree, which is
+ * enough to build topological sorts and strongly connected components
+ * without walking the graph again.
+ */
+
+#ifndef DFS_H
+#define DFS_H
+
+#include "instrument.h"
+#include "visitor.h"
+#include <vector>
+
+using namespace std;
+
+// result of a depth-first search, indexed by vertex id
+// every entry is -1 for vertices the search did not reach, and parent
+// is also -1 for the vertices a search was started from
+struct DfsResult {
+  vector<int> preorder;  // 0 for the first vertex entered, 1 for the next
+  vector<int> postorder; // 0 for the first vertex finished, 1 for the next
+  vector<int> discovery; // clock time the vertex was entered
+  vector<int> finish;    // clock time the vertex was finished
+  vector<int> parent;    // vertex the search came from
+
+  // empty result for n vertices, nothing reached yet
+  explicit DfsResult(int n = 0)
+      : preorder(n, -1), postorder(n, -1), discovery(n, -1), finish(n, -1),
+        parent(n, -1) {}
+};
+
+// depth-first search from each root in turn, skipping roots an
+// earlier search already reached, so several roots build one forest
+// visit(int id) is called as each vertex is entered, see visitor.h; if
+// it returns false the search stops, leaving the vertices still on the
+// stack unfinished
+template <typename View, typename Visit>
+DfsResult dfsSearch(const View &view, const vector<int> &roots,
+                    Visit visit) {
+  DfsResult result(view.size());
+  int pre = 0;
+  int post = 0;
+  int clock = 0;
+  // neighbours of every vertex on the stack, in visit order
+  vector<int> pending;
+  // a vertex on the stack, its neighbours are pending[begin..] and
+  // pending[next] is the next one to look at
+  struct Frame {
+    int vertex;
+    size_t begin;
+    size_t next;
+  };
+  vector<Frame> stack;
+  // @return false if the visitor asked to stop
+  auto enter = [&](int v) {
+    GRAPH_COUNT(settled, 1);
+    result.preorder[v] = pre++;
+    result.discovery[v] = clock++;
+    if (!visitAndContinue(visit, v)) {
+      return false;
+    }
+    stack.push_back(Frame{v, pending.size(), pending.size()});
+    view.forEachSortedEdge(v, [&pending](int to, typename View::Weight) {
+      pending.push_back(to);
+    });
+    return true;
+  };
+  for (int root : roots) {
+    if (result.discovery[root] != -1) {
+      continue;
+    }
+    if (!enter(root)) {
+      return result;
+    }
+    while (!stack.empty()) {
+      Frame &top = stack.back();
+      if (top.next == pending.size()) {
+        // the top vertex's neighbours are always last in pending
+        result.postorder[top.vertex] = post++;
+        result.finish[top.vertex] = clock++;
+        pending.resize(top.begin);
+        stack.pop_back();
+        if (!stack.empty()) {
+          ++stack.back().next;
+        }
+        continue;
+      }
+      int to = pending[top.next];
+      GRAPH_COUNT(relaxed, 1);
+      if (result.discovery[to] != -1) {
+        ++top.next;
+        continue;
+      }
+      result.parent[to] = top.vertex;
+      if (!enter(to)) {
+        return result;
+      }
+    }
+  }
+  return result;
+}
+
+#endif // DFS_H
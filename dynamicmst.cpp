@@ -0,0 +1,230 @@
+#include "dynamicmst.h"
+#include "unionfind.h"
+#include <limits>
+#include <tuple>
+
+using namespace std;
+
+// minimum spanning forest of the current graph, which must outlive it
+// built with Kruskal's algorithm over every edge of the graph
+DynamicMst::DynamicMst(Graph &graph)
+    : graph(graph), total(0), treeEdges(0), stamp(0) {
+  addVertices();
+  if (graph.isDirectional()) {
+    total = -1;
+    return;
+  }
+  vector<MstEdge<int>> all;
+  for (VertexId from = 0; from < graph.verticesSize(); ++from) {
+    graph.forEachEdge(from, [&](VertexId to, int weight) {
+      if (from < to) {
+        all.push_back(MstEdge<int>{from, to, weight});
+      }
+    });
+  }
+  stable_sort(all.begin(), all.end(),
+              [](const MstEdge<int> &a, const MstEdge<int> &b) {
+                return a.weight < b.weight;
+              });
+  DisjointSets sets(graph.verticesSize());
+  for (auto const &edge : all) {
+    if (sets.unite(edge.from, edge.to)) {
+      link(edge.from, edge.to, edge.weight);
+    }
+  }
+  graph.addObserver(this);
+}
+
+// stop observing the graph
+DynamicMst::~DynamicMst() { graph.removeObserver(this); }
+
+// add the vertices the graph gained since the last call
+void DynamicMst::addVertices() {
+  while (static_cast<int>(vertexNode.size()) < graph.verticesSize()) {
+    // vertices never win a path maximum against an edge
+    vertexNode.push_back(forest.add(numeric_limits<int>::min()));
+  }
+  tree.resize(vertexNode.size());
+  mark.resize(vertexNode.size(), 0);
+}
+
+// add the tree edge between from and to
+void DynamicMst::link(VertexId from, VertexId to, int weight) {
+  int node = forest.add(weight);
+  forest.link(vertexNode[from], node);
+  forest.link(node, vertexNode[to]);
+  if (node >= static_cast<int>(ends.size())) {
+    ends.resize(node + 1);
+  }
+  ends[node] = make_pair(from, to);
+  tree[from].push_back(TreeEdge{to, node});
+  tree[to].push_back(TreeEdge{from, node});
+  total += weight;
+  ++treeEdges;
+}
+
+// remove the tree edge between from and to
+// @return its weight
+int DynamicMst::cut(VertexId from, VertexId to) {
+  int i = findTreeEdge(from, to);
+  int node = tree[from][i].node;
+  tree[from][i] = tree[from].back();
+  tree[from].pop_back();
+  i = findTreeEdge(to, from);
+  tree[to][i] = tree[to].back();
+  tree[to].pop_back();
+  int weight = forest.value(node);
+  forest.cut(vertexNode[from], node);
+  forest.cut(node, vertexNode[to]);
+  forest.remove(node);
+  total -= weight;
+  --treeEdges;
+  return weight;
+}
+
+// update the forest after the graph gained the edge between from and to
+void DynamicMst::added(VertexId from, VertexId to, int weight) {
+  int a = vertexNode[from];
+  int b = vertexNode[to];
+  if (!forest.connected(a, b)) {
+    link(from, to, weight);
+    return;
+  }
+  // the edge closes a cycle, the heaviest edge on it is not needed
+  int heaviest = forest.pathMax(a, b);
+  if (forest.value(heaviest) > weight) {
+    pair<VertexId, VertexId> old = ends[heaviest];
+    cut(old.first, old.second);
+    link(from, to, weight);
+  }
+}
+
+// @return position of to in the tree edges of from, -1 if not there
+int DynamicMst::findTreeEdge(VertexId from, VertexId to) const {
+  for (size_t i = 0; i < tree[from].size(); ++i) {
+    if (tree[from][i].to == to) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// join the two trees left after the tree edge between from and to was
+// removed, with the lightest graph edge between them if there is one
+void DynamicMst::reconnect(VertexId from, VertexId to) {
+  // walk both trees one vertex at a time, the first to run out is the
+  // smaller one and every edge leaving it goes to the other
+  stamp += 2;
+  unsigned fromSide = stamp - 1;
+  unsigned toSide = stamp;
+  vector<VertexId> fromWalk(1, from);
+  vector<VertexId> toWalk(1, to);
+  mark[from] = fromSide;
+  mark[to] = toSide;
+  auto step = [this](vector<VertexId> &walk, size_t head, unsigned side) {
+    for (auto const &edge : tree[walk[head]]) {
+      if (mark[edge.to] != side) {
+        mark[edge.to] = side;
+        walk.push_back(edge.to);
+      }
+    }
+  };
+  size_t head = 0;
+  while (head < fromWalk.size() && head < toWalk.size()) {
+    step(fromWalk, head, fromSide);
+    step(toWalk, head, toSide);
+    ++head;
+  }
+  bool fromSmaller = head == fromWalk.size();
+  const vector<VertexId> &smaller = fromSmaller ? fromWalk : toWalk;
+  unsigned side = fromSmaller ? fromSide : toSide;
+  VertexId bestFrom = -1;
+  VertexId bestTo = -1;
+  int bestWeight = numeric_limits<int>::max();
+  for (VertexId v : smaller) {
+    graph.forEachEdge(v, [&](VertexId other, int weight) {
+      if (mark[other] != side && (bestFrom == -1 || weight < bestWeight)) {
+        bestFrom = v;
+        bestTo = other;
+        bestWeight = weight;
+      }
+    });
+  }
+  if (bestFrom != -1) {
+    link(bestFrom, bestTo, bestWeight);
+  }
+}
+
+// connect two vertices in the graph, same rules as Graph::connect
+// @return true if successfully connected, false for a directed graph
+bool DynamicMst::connect(const string &from, const string &to, int weight) {
+  return !graph.isDirectional() && graph.connect(from, to, weight);
+}
+
+// same as above, for vertices given by id
+bool DynamicMst::connect(VertexId from, VertexId to, int weight) {
+  return !graph.isDirectional() && graph.connect(from, to, weight);
+}
+
+// disconnect two vertices in the graph
+// @return true if the edge was there, false for a directed graph
+bool DynamicMst::disconnect(const string &from, const string &to) {
+  return !graph.isDirectional() && graph.disconnect(from, to);
+}
+
+// same as above, for vertices given by id
+bool DynamicMst::disconnect(VertexId from, VertexId to) {
+  return !graph.isDirectional() && graph.disconnect(from, to);
+}
+
+// update the forest after the graph gained an edge
+void DynamicMst::edgeAdded(VertexId from, VertexId to, int weight) {
+  addVertices();
+  added(from, to, weight);
+}
+
+// update the forest after the graph lost an edge
+void DynamicMst::edgeRemoved(VertexId from, VertexId to, int) {
+  addVertices();
+  if (findTreeEdge(from, to) != -1) {
+    cut(from, to);
+    reconnect(from, to);
+  }
+}
+
+// @return total weight of the forest, -1 for a directed graph
+long long DynamicMst::totalWeight() const { return total; }
+
+// @return number of edges in the forest
+int DynamicMst::edgesSize() const { return treeEdges; }
+
+// @return true if the edge between from and to is in the forest
+bool DynamicMst::contains(VertexId from, VertexId to) const {
+  return from >= 0 && from < static_cast<int>(tree.size()) && to >= 0 &&
+         findTreeEdge(from, to) != -1;
+}
+
+// call visit(from, to, weight) on every edge of the forest, from is the
+// end with the smaller label, ordered by from and then to
+void DynamicMst::edges(void visit(const string &from, const string &to,
+                                  int weight)) const {
+  vector<tuple<const string *, const string *, int>> sorted;
+  sorted.reserve(treeEdges);
+  edges([&](VertexId from, VertexId to, int weight) {
+    const string *a = &graph.label(from);
+    const string *b = &graph.label(to);
+    if (*b < *a) {
+      swap(a, b);
+    }
+    sorted.emplace_back(a, b, weight);
+  });
+  sort(sorted.begin(), sorted.end(),
+       [](const tuple<const string *, const string *, int> &x,
+          const tuple<const string *, const string *, int> &y) {
+         int byFrom = get<0>(x)->compare(*get<0>(y));
+         return byFrom < 0 || (byFrom == 0 && *get<1>(x) < *get<1>(y));
+       });
+  for (auto const &edge : sorted) {
+    visit(*get<0>(edge), *get<1>(edge), get<2>(edge));
+  }
+}
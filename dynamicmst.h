@@ -0,0 +1,145 @@
+/**
+ * A DynamicMst keeps a minimum spanning forest of an undirected Graph up
+ * to date while edges are added and removed, instead of running
+ * mstKruskal or mstPrim again after every change.
+ * It is built from the current graph and then observes it, see
+ * Graph::addObserver, so every edge added or removed later, through the
+ * DynamicMst or straight on the graph, updates the forest.
+ * The forest is kept in a LinkCutForest where every tree edge is a node
+ * holding its weight, so the heaviest edge between two vertices is found
+ * in O(log n).
+ *  - Adding an edge whose ends are in different trees links the trees.
+ *    Otherwise it closes a cycle, and it replaces the heaviest tree edge
+ *    on the path between its ends if it is lighter (cycle property).
+ *  - Removing a non-tree edge changes nothing. Removing a tree edge
+ *    splits its tree; the smaller half is found by walking both halves
+ *    in step until one runs out, and the lightest graph edge leaving it,
+ *    if any, joins the halves again (cut property). This costs the size
+ *    and edges of the smaller half, not of the whole graph.
+ *
+ * The graph must outlive the DynamicMst. A DynamicMst of a directed
+ * graph stays empty.
+ */
+
+#ifndef DYNAMICMST_H
+#define DYNAMICMST_H
+
+#include "graph.h"
+#include "linkcut.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class DynamicMst : public GraphObserver {
+private:
+  // a tree edge as seen from one end, node is its node in forest
+  struct TreeEdge {
+    VertexId to;
+    int node;
+  };
+
+  Graph &graph;
+  LinkCutForest forest;
+  // node of every vertex in forest
+  vector<int> vertexNode;
+  // tree edges of every vertex
+  vector<vector<TreeEdge>> tree;
+  // ends of every tree edge by its node in forest
+  vector<pair<VertexId, VertexId>> ends;
+  long long total;
+  int treeEdges;
+  // marks for the walk that splits a tree, a vertex is on the side of
+  // from or to if its mark is the matching stamp
+  vector<unsigned> mark;
+  unsigned stamp;
+
+  // add the vertices the graph gained since the last call
+  void addVertices();
+
+  // add the tree edge between from and to
+  void link(VertexId from, VertexId to, int weight);
+
+  // remove the tree edge between from and to
+  // @return its weight
+  int cut(VertexId from, VertexId to);
+
+  // update the forest after the graph gained the edge between from and to
+  void added(VertexId from, VertexId to, int weight);
+
+  // @return position of to in the tree edges of from, -1 if not there
+  int findTreeEdge(VertexId from, VertexId to) const;
+
+  // join the two trees left after the tree edge between from and to was
+  // removed, with the lightest graph edge between them if there is one
+  void reconnect(VertexId from, VertexId to);
+
+public:
+  // minimum spanning forest of the current graph, which must outlive it
+  explicit DynamicMst(Graph &graph);
+
+  // stop observing the graph
+  ~DynamicMst() override;
+
+  // copy not allowed
+  DynamicMst(const DynamicMst &other) = delete;
+
+  // assignment not allowed
+  DynamicMst &operator=(const DynamicMst &other) = delete;
+
+  // connect two vertices in the graph, same rules as Graph::connect
+  // @return true if successfully connected, false for a directed graph
+  bool connect(const string &from, const string &to, int weight);
+
+  // same as above, for vertices given by id
+  bool connect(VertexId from, VertexId to, int weight);
+
+  // disconnect two vertices in the graph
+  // @return true if the edge was there, false for a directed graph
+  bool disconnect(const string &from, const string &to);
+
+  // same as above, for vertices given by id
+  bool disconnect(VertexId from, VertexId to);
+
+  // update the forest after the graph gained an edge
+  void edgeAdded(VertexId from, VertexId to, int weight) override;
+
+  // update the forest after the graph lost an edge
+  void edgeRemoved(VertexId from, VertexId to, int weight) override;
+
+  // @return total weight of the forest, -1 for a directed graph
+  long long totalWeight() const;
+
+  // @return number of edges in the forest
+  int edgesSize() const;
+
+  // @return true if the edge between from and to is in the forest
+  bool contains(VertexId from, VertexId to) const;
+
+  // call visit(from, to, weight) on every edge of the forest, from is the
+  // end with the smaller label, ordered by from and then to
+  void edges(void visit(const string &from, const string &to,
+                        int weight)) const;
+
+  // call visit(from, to, weight) on every edge of the forest, from is the
+  // end with the smaller id, ordered by from and then to
+  template <typename Visit> void edges(Visit visit) const {
+    vector<TreeEdge> sorted;
+    for (VertexId from = 0; from < static_cast<int>(tree.size()); ++from) {
+      sorted.clear();
+      for (auto const &edge : tree[from]) {
+        if (from < edge.to) {
+          sorted.push_back(edge);
+        }
+      }
+      sort(sorted.begin(), sorted.end(),
+           [](const TreeEdge &a, const TreeEdge &b) { return a.to < b.to; });
+      for (auto const &edge : sorted) {
+        visit(from, edge.to, forest.value(edge.node));
+      }
+    }
+  }
+};
+
+#endif // DYNAMICMST_H
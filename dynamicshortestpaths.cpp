@@ -0,0 +1,231 @@
+#include "dynamicshortestpaths.h"
+#include <climits>
+
+using namespace std;
+
+// observe graph, no sources yet
+DynamicShortestPaths::DynamicShortestPaths(Graph &graph)
+    : graph(graph), heap(0) {
+  addVertices();
+  if (graph.isDirectional()) {
+    for (VertexId from = 0; from < graph.verticesSize(); ++from) {
+      graph.forEachEdge(from, [&](VertexId to, int weight) {
+        incoming[to].emplace_back(from, weight);
+      });
+    }
+  }
+  graph.addObserver(this);
+}
+
+// stop observing the graph
+DynamicShortestPaths::~DynamicShortestPaths() {
+  graph.removeObserver(this);
+}
+
+// grow everything to the number of vertices in the graph
+void DynamicShortestPaths::addVertices() {
+  int n = graph.verticesSize();
+  if (static_cast<int>(affected.size()) >= n) {
+    return;
+  }
+  affected.resize(n, false);
+  if (graph.isDirectional()) {
+    incoming.resize(n);
+  }
+  for (auto &tree : trees) {
+    tree.dist.resize(n, INT_MAX);
+    tree.prev.resize(n, -1);
+  }
+  heap.resize(n);
+}
+
+// @return the tree of source, nullptr if it is not a source
+const DynamicShortestPaths::Tree *
+DynamicShortestPaths::find(VertexId source) const {
+  for (auto const &tree : trees) {
+    if (tree.source == source) {
+      return &tree;
+    }
+  }
+  return nullptr;
+}
+
+// settle the vertices in the heap and everything they improve
+void DynamicShortestPaths::settle(Tree &tree) {
+  while (!heap.empty()) {
+    VertexId curr = heap.pop();
+    int base = tree.dist[curr];
+    graph.forEachEdge(curr, [&](VertexId to, int weight) {
+      int length;
+      if (extendPath(base, weight, length) && length < tree.dist[to]) {
+        tree.dist[to] = length;
+        tree.prev[to] = curr;
+        heap.push(to, tree.dist[to]);
+      }
+    });
+  }
+}
+
+// repair tree after the edge from -> to was added
+// only paths that can now go through the new edge get shorter
+void DynamicShortestPaths::repairAdded(Tree &tree, VertexId from,
+                                       VertexId to, int weight) {
+  int length;
+  if (tree.dist[from] == INT_MAX ||
+      !extendPath(tree.dist[from], weight, length) ||
+      length >= tree.dist[to]) {
+    return;
+  }
+  tree.dist[to] = length;
+  tree.prev[to] = from;
+  heap.push(to, tree.dist[to]);
+  settle(tree);
+}
+
+// repair tree after the edge from -> to was removed
+// only the vertices under to in the tree can get further away
+void DynamicShortestPaths::repairRemoved(Tree &tree, VertexId from,
+                                         VertexId to) {
+  if (tree.prev[to] != from) {
+    return;
+  }
+  subtree.assign(1, to);
+  affected[to] = true;
+  for (size_t i = 0; i < subtree.size(); ++i) {
+    VertexId curr = subtree[i];
+    graph.forEachEdge(curr, [&](VertexId next, int) {
+      if (!affected[next] && tree.prev[next] == curr) {
+        affected[next] = true;
+        subtree.push_back(next);
+      }
+    });
+  }
+  for (VertexId v : subtree) {
+    tree.dist[v] = INT_MAX;
+    tree.prev[v] = -1;
+  }
+  // the best way into the subtree from outside, then paths inside it
+  for (VertexId v : subtree) {
+    forEachIncoming(v, [&](VertexId other, int weight) {
+      int length;
+      if (!affected[other] && tree.dist[other] != INT_MAX &&
+          extendPath(tree.dist[other], weight, length) &&
+          length < tree.dist[v]) {
+        tree.dist[v] = length;
+        tree.prev[v] = other;
+      }
+    });
+    if (tree.dist[v] != INT_MAX) {
+      heap.push(v, tree.dist[v]);
+    }
+  }
+  settle(tree);
+  for (VertexId v : subtree) {
+    affected[v] = false;
+  }
+}
+
+// keep the shortest paths from source up to date, one Dijkstra search
+// @return false if source is not in the graph or already a source
+bool DynamicShortestPaths::addSource(const string &source) {
+  return addSource(graph.id(source));
+}
+
+// same as above, for a vertex given by id
+bool DynamicShortestPaths::addSource(VertexId source) {
+  if (graph.vertexDegree(source) == -1 || find(source) != nullptr) {
+    return false;
+  }
+  addVertices();
+  pair<vector<int>, vector<VertexId>> found = graph.dijkstra(source);
+  trees.push_back(Tree{source, move(found.first), move(found.second)});
+  return true;
+}
+
+// stop keeping the shortest paths from source
+// @return false if it was not a source
+bool DynamicShortestPaths::removeSource(const string &source) {
+  return removeSource(graph.id(source));
+}
+
+// same as above, for a vertex given by id
+bool DynamicShortestPaths::removeSource(VertexId source) {
+  for (size_t i = 0; i < trees.size(); ++i) {
+    if (trees[i].source == source) {
+      trees.erase(trees.begin() + i);
+      return true;
+    }
+  }
+  return false;
+}
+
+// @return same as Graph::dijkstra(source), without searching
+// empty maps if source was not added
+pair<map<string, int>, map<string, string>>
+DynamicShortestPaths::dijkstra(const string &source) const {
+  map<string, int> weights;
+  map<string, string> previous;
+  const Tree *tree = find(graph.id(source));
+  if (tree != nullptr) {
+    for (VertexId i = 0; i < static_cast<int>(tree->prev.size()); ++i) {
+      if (tree->prev[i] != -1) {
+        weights[graph.label(i)] = tree->dist[i];
+        previous[graph.label(i)] = graph.label(tree->prev[i]);
+      }
+    }
+  }
+  return make_pair(weights, previous);
+}
+
+// @return same as Graph::dijkstra(source) over vertex ids, empty
+// vectors if source was not added
+pair<vector<int>, vector<VertexId>>
+DynamicShortestPaths::dijkstra(VertexId source) const {
+  vector<int> dist;
+  vector<VertexId> prev;
+  const Tree *tree = find(source);
+  if (tree != nullptr) {
+    // vertices added without edges are not reported, they are unreached
+    dist = tree->dist;
+    prev = tree->prev;
+    dist.resize(graph.verticesSize(), INT_MAX);
+    prev.resize(graph.verticesSize(), -1);
+  }
+  return make_pair(dist, prev);
+}
+
+// repair every tree after the graph gained an edge
+void DynamicShortestPaths::edgeAdded(VertexId from, VertexId to,
+                                     int weight) {
+  addVertices();
+  if (graph.isDirectional()) {
+    incoming[to].emplace_back(from, weight);
+  }
+  for (auto &tree : trees) {
+    repairAdded(tree, from, to, weight);
+    if (!graph.isDirectional()) {
+      repairAdded(tree, to, from, weight);
+    }
+  }
+}
+
+// repair every tree after the graph lost an edge
+void DynamicShortestPaths::edgeRemoved(VertexId from, VertexId to, int) {
+  addVertices();
+  if (graph.isDirectional()) {
+    vector<pair<VertexId, int>> &into = incoming[to];
+    for (size_t i = 0; i < into.size(); ++i) {
+      if (into[i].first == from) {
+        into[i] = into.back();
+        into.pop_back();
+        break;
+      }
+    }
+  }
+  for (auto &tree : trees) {
+    repairRemoved(tree, from, to);
+    if (!graph.isDirectional()) {
+      repairRemoved(tree, to, from);
+    }
+  }
+}
@@ -0,0 +1,125 @@
+/**
+ * DynamicShortestPaths keeps the shortest path trees of a few sources of
+ * a Graph up to date while edges are added and removed, so the result
+ * of Graph::dijkstra for those sources never has to be recomputed.
+ * It observes the graph, see Graph::addObserver, and repairs only the
+ * part of each tree a change can affect (Ramalingam and Reps):
+ *  - An added edge u -> v that shortens the path to v starts a Dijkstra
+ *    search from v that stops where distances no longer improve.
+ *  - A removed edge that is not in a tree changes nothing. Removing a
+ *    tree edge u -> v only lengthens paths through v, so the subtree
+ *    under v is cut loose, every vertex in it takes the best distance
+ *    offered by an edge from outside the subtree, and a Dijkstra search
+ *    limited to the subtree settles the rest.
+ * The work is proportional to the vertices whose distance or previous
+ * vertex changes and their edges, not to the size of the graph.
+ * Distances are always the ones Graph::dijkstra would return. Where a
+ * vertex has several shortest paths the previous vertex kept may be a
+ * different one of them.
+ *
+ * Directed graphs need the edges into a vertex to repair a subtree,
+ * which Graph does not keep, so they are kept here. Edge weights must
+ * not be negative. The graph must outlive the DynamicShortestPaths.
+ */
+
+#ifndef DYNAMICSHORTESTPATHS_H
+#define DYNAMICSHORTESTPATHS_H
+
+#include "graph.h"
+#include "heap.h"
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+class DynamicShortestPaths : public GraphObserver {
+private:
+  // shortest path tree of one source, as returned by Graph::dijkstra
+  struct Tree {
+    VertexId source;
+    vector<int> dist;
+    vector<VertexId> prev;
+  };
+
+  Graph &graph;
+  vector<Tree> trees;
+  // edges into every vertex, only kept for directed graphs
+  vector<vector<pair<VertexId, int>>> incoming;
+  // working memory of a repair
+  BinaryHeap<int> heap;
+  vector<bool> affected;
+  vector<VertexId> subtree;
+
+  // grow everything to the number of vertices in the graph
+  void addVertices();
+
+  // @return the tree of source, nullptr if it is not a source
+  const Tree *find(VertexId source) const;
+
+  // call f(from, weight) for every edge into v
+  template <typename F> void forEachIncoming(VertexId v, F f) const {
+    if (graph.isDirectional()) {
+      for (auto const &edge : incoming[v]) {
+        f(edge.first, edge.second);
+      }
+    } else {
+      graph.forEachEdge(v, f);
+    }
+  }
+
+  // settle the vertices in the heap and everything they improve
+  void settle(Tree &tree);
+
+  // repair tree after the edge from -> to was added
+  void repairAdded(Tree &tree, VertexId from, VertexId to, int weight);
+
+  // repair tree after the edge from -> to was removed
+  void repairRemoved(Tree &tree, VertexId from, VertexId to);
+
+public:
+  // observe graph, no sources yet
+  explicit DynamicShortestPaths(Graph &graph);
+
+  // stop observing the graph
+  ~DynamicShortestPaths() override;
+
+  // copy not allowed
+  DynamicShortestPaths(const DynamicShortestPaths &other) = delete;
+
+  // assignment not allowed
+  DynamicShortestPaths &
+  operator=(const DynamicShortestPaths &other) = delete;
+
+  // keep the shortest paths from source up to date, one Dijkstra search
+  // @return false if source is not in the graph or already a source
+  bool addSource(const string &source);
+
+  // same as above, for a vertex given by id
+  bool addSource(VertexId source);
+
+  // stop keeping the shortest paths from source
+  // @return false if it was not a source
+  bool removeSource(const string &source);
+
+  // same as above, for a vertex given by id
+  bool removeSource(VertexId source);
+
+  // @return same as Graph::dijkstra(source), without searching
+  // empty maps if source was not added
+  pair<map<string, int>, map<string, string>>
+  dijkstra(const string &source) const;
+
+  // @return same as Graph::dijkstra(source) over vertex ids, empty
+  // vectors if source was not added
+  pair<vector<int>, vector<VertexId>> dijkstra(VertexId source) const;
+
+  // repair every tree after the graph gained an edge
+  void edgeAdded(VertexId from, VertexId to, int weight) override;
+
+  // repair every tree after the graph lost an edge
+  void edgeRemoved(VertexId from, VertexId to, int weight) override;
+};
+
+#endif // DYNAMICSHORTESTPATHS_H
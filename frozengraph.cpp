@@ -0,0 +1,592 @@
+#include "frozengraph.h"
+#include "graph.h"
+#include "mst.h"
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// integer id view of the adjacency used by the search engines
+struct FrozenGraph::CsrView {
+  typedef int Weight;
+  const FrozenGraph &graph;
+  int size() const { return graph.verticesSize(); }
+  template <typename F> void forEachEdge(int from, F f) const {
+    for (int i = graph.offsets[from]; i < graph.offsets[from + 1]; ++i) {
+      f(graph.targets[i], graph.weights[i]);
+    }
+  }
+  // rows are stored in label order already
+  template <typename F> void forEachSortedEdge(int from, F f) const {
+    forEachEdge(from, f);
+  }
+};
+
+// Binary file layout, all integers in the byte order of the writer,
+// which byteOrder records:
+//   BinaryHeader
+//   int labelOffsets[vertexCount + 1]
+//   int offsets[vertexCount + 1]
+//   int targets[targetCount]
+//   int weights[targetCount]
+//   char labelChars[labelBytes]
+// Bump BINARY_VERSION whenever the layout changes.
+namespace {
+const char BINARY_MAGIC[8] = {'G', 'R', 'A', 'P', 'H', 'C', 'S', 'R'};
+const uint32_t BINARY_VERSION = 2;
+// reads back byte swapped on a machine of the other byte order
+const uint64_t BINARY_BYTE_ORDER = 0x0102030405060708ULL;
+const uint64_t BINARY_BYTE_ORDER_SWAPPED = 0x0807060504030201ULL;
+
+struct BinaryHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t directional;
+  uint64_t byteOrder;
+  uint64_t vertexCount;
+  uint64_t targetCount;
+  uint64_t edgeCount;
+  uint64_t labelBytes;
+};
+} // namespace
+
+// empty graph, use readBinary to fill it
+FrozenGraph::FrozenGraph()
+    : directional(true), vertexCount(0), edgeCount(0), mapping(nullptr),
+      mappingSize(0), transposeLock(new mutex()) {
+  storage.labelOffsets.push_back(0);
+  storage.offsets.push_back(0);
+  useStorage();
+}
+
+// snapshot of the vertices and edges currently in graph
+// ids are handed out in label order, so rows sorted by id are also
+// sorted by label
+FrozenGraph::FrozenGraph(const Graph &graph)
+    : directional(graph.isDirectional()), vertexCount(graph.verticesSize()),
+      edgeCount(0), mapping(nullptr), mappingSize(0),
+      transposeLock(new mutex()) {
+  vector<VertexId> order(vertexCount);
+  for (VertexId i = 0; i < vertexCount; ++i) {
+    order[i] = i;
+  }
+  sort(order.begin(), order.end(), [&graph](VertexId a, VertexId b) {
+    return graph.label(a) < graph.label(b);
+  });
+  vector<int> rank(vertexCount);
+  storage.labelOffsets.reserve(vertexCount + 1);
+  storage.labelOffsets.push_back(0);
+  for (int i = 0; i < vertexCount; ++i) {
+    rank[order[i]] = i;
+    const string &label = graph.label(order[i]);
+    storage.labelChars.insert(storage.labelChars.end(), label.begin(),
+                              label.end());
+    storage.labelOffsets.push_back(storage.labelChars.size());
+  }
+  storage.offsets.reserve(vertexCount + 1);
+  storage.offsets.push_back(0);
+  vector<pair<int, int>> row;
+  for (VertexId v : order) {
+    row.clear();
+    graph.forEachEdge(v, [&row, &rank](VertexId to, int weight) {
+      row.emplace_back(rank[to], weight);
+    });
+    sort(row.begin(), row.end());
+    for (auto const &j : row) {
+      storage.targets.push_back(j.first);
+      storage.weights.push_back(j.second);
+    }
+    storage.offsets.push_back(storage.targets.size());
+  }
+  // undirected graphs store every edge in both directions
+  int stored = storage.targets.size();
+  edgeCount = directional ? stored : stored / 2;
+  useStorage();
+}
+
+// move allowed, the arrays and the mapping change owner
+FrozenGraph::FrozenGraph(FrozenGraph &&other) noexcept
+    : mapping(nullptr), mappingSize(0), transposeLock(new mutex()) {
+  *this = move(other);
+}
+
+// move assignment, the arrays and the mapping change owner
+FrozenGraph &FrozenGraph::operator=(FrozenGraph &&other) noexcept {
+  if (this == &other) {
+    return *this;
+  }
+  unmap();
+  directional = other.directional;
+  vertexCount = other.vertexCount;
+  edgeCount = other.edgeCount;
+  storage = move(other.storage);
+  mapping = other.mapping;
+  mappingSize = other.mappingSize;
+  labelOffsets = other.labelOffsets;
+  labelChars = other.labelChars;
+  offsets = other.offsets;
+  targets = other.targets;
+  weights = other.weights;
+  transpose = move(other.transpose);
+  other.mapping = nullptr;
+  other.mappingSize = 0;
+  if (mapping == nullptr) {
+    useStorage();
+  }
+  // leave other as a valid empty graph
+  other.vertexCount = 0;
+  other.edgeCount = 0;
+  other.storage = Storage();
+  other.storage.labelOffsets.push_back(0);
+  other.storage.offsets.push_back(0);
+  other.useStorage();
+  return *this;
+}
+
+// destructor, unmaps the file if the graph was read with readBinary
+FrozenGraph::~FrozenGraph() { unmap(); }
+
+// point the arrays at storage
+void FrozenGraph::useStorage() {
+  labelOffsets = storage.labelOffsets.data();
+  labelChars = storage.labelChars.data();
+  offsets = storage.offsets.data();
+  targets = storage.targets.data();
+  weights = storage.weights.data();
+}
+
+// unmap the file if one is mapped
+void FrozenGraph::unmap() {
+  if (mapping != nullptr) {
+    munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+  }
+}
+
+// write the header followed by the arrays
+bool FrozenGraph::writeBinary(const string &filename) const {
+  ofstream out(filename, ios::binary | ios::trunc);
+  if (!out.is_open()) {
+    cerr << "Failed to open " << filename << endl;
+    return false;
+  }
+  BinaryHeader header;
+  memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+  header.version = BINARY_VERSION;
+  header.directional = directional ? 1 : 0;
+  header.byteOrder = BINARY_BYTE_ORDER;
+  header.vertexCount = vertexCount;
+  header.targetCount = offsets[vertexCount];
+  header.edgeCount = edgeCount;
+  header.labelBytes = labelOffsets[vertexCount];
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(labelOffsets),
+            sizeof(int) * (vertexCount + 1));
+  out.write(reinterpret_cast<const char *>(offsets),
+            sizeof(int) * (vertexCount + 1));
+  out.write(reinterpret_cast<const char *>(targets),
+            sizeof(int) * header.targetCount);
+  out.write(reinterpret_cast<const char *>(weights),
+            sizeof(int) * header.targetCount);
+  out.write(labelChars, header.labelBytes);
+  out.close();
+  if (!out) {
+    cerr << "Failed to write " << filename << endl;
+    return false;
+  }
+  return true;
+}
+
+// map a file written by writeBinary, nothing is parsed or copied
+// the header and the array sizes are checked, then one pass over the
+// arrays checks that offsets start at 0, never decrease and end at their
+// array sizes, and that every target is a vertex, so a file that passes
+// can be traversed without reading outside the mapping
+bool FrozenGraph::readBinary(const string &filename) {
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1) {
+    cerr << "Failed to open " << filename << endl;
+    return false;
+  }
+  struct stat info;
+  void *mapped = MAP_FAILED;
+  size_t size = 0;
+  if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(BinaryHeader)) {
+    size = info.st_size;
+    mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    cerr << "Failed to map " << filename << endl;
+    return false;
+  }
+  const char *base = static_cast<const char *>(mapped);
+  const BinaryHeader *header = reinterpret_cast<const BinaryHeader *>(base);
+  uint64_t n = header->vertexCount;
+  uint64_t m = header->targetCount;
+  uint64_t expected = sizeof(BinaryHeader) + sizeof(int) * (2 * (n + 1)) +
+                      sizeof(int) * (2 * m) + header->labelBytes;
+  bool valid =
+      memcmp(header->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0 &&
+      header->version == BINARY_VERSION &&
+      header->byteOrder == BINARY_BYTE_ORDER && n < INT_MAX &&
+      m < INT_MAX && header->edgeCount <= m &&
+      header->labelBytes < INT_MAX && expected == size;
+  if (valid) {
+    // the offset arrays must start at 0 and end at their array sizes
+    const int *ends = reinterpret_cast<const int *>(base + sizeof(*header));
+    valid = ends[0] == 0 && ends[n] == (int64_t)header->labelBytes &&
+            ends[n + 1] == 0 && ends[2 * n + 1] == (int64_t)m;
+    // in between they must not decrease, and targets must be vertices
+    for (uint64_t i = 0; valid && i < n; ++i) {
+      valid = ends[i] <= ends[i + 1] && ends[n + 1 + i] <= ends[n + 2 + i];
+    }
+    const int *found = ends + 2 * (n + 1);
+    for (uint64_t i = 0; valid && i < m; ++i) {
+      valid = found[i] >= 0 && (uint64_t)found[i] < n;
+    }
+  }
+  if (!valid) {
+    if (memcmp(header->magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0 &&
+        header->byteOrder == BINARY_BYTE_ORDER_SWAPPED) {
+      cerr << "Graph binary file of the other byte order " << filename
+           << endl;
+    } else {
+      cerr << "Not a graph binary file " << filename << endl;
+    }
+    munmap(mapped, size);
+    return false;
+  }
+  unmap();
+  storage = Storage();
+  transpose.reset();
+  mapping = mapped;
+  mappingSize = size;
+  directional = header->directional != 0;
+  vertexCount = n;
+  edgeCount = header->edgeCount;
+  const int *arrays = reinterpret_cast<const int *>(base + sizeof(*header));
+  labelOffsets = arrays;
+  offsets = labelOffsets + n + 1;
+  targets = offsets + n + 1;
+  weights = targets + m;
+  labelChars = reinterpret_cast<const char *>(weights + m);
+  return true;
+}
+
+// @return the out-edges as CSR arrays
+CsrArrays FrozenGraph::outEdges() const {
+  return CsrArrays{vertexCount, offsets, targets};
+}
+
+// @return the in-edges as CSR arrays, the out-edges if undirected
+// a directed graph builds its reverse adjacency once, on first use
+CsrArrays FrozenGraph::inEdges() const {
+  if (!directional) {
+    return outEdges();
+  }
+  lock_guard<mutex> guard(*transposeLock);
+  if (!transpose) {
+    unique_ptr<Transpose> built(new Transpose());
+    built->offsets.assign(vertexCount + 1, 0);
+    built->sources.resize(offsets[vertexCount]);
+    for (int i = 0; i < offsets[vertexCount]; ++i) {
+      ++built->offsets[targets[i] + 1];
+    }
+    for (int v = 0; v < vertexCount; ++v) {
+      built->offsets[v + 1] += built->offsets[v];
+    }
+    // sources are added in increasing order, so rows stay sorted
+    vector<int> next(built->offsets.begin(), built->offsets.end() - 1);
+    for (int u = 0; u < vertexCount; ++u) {
+      for (int i = offsets[u]; i < offsets[u + 1]; ++i) {
+        built->sources[next[targets[i]]++] = u;
+      }
+    }
+    transpose = move(built);
+  }
+  return CsrArrays{vertexCount, transpose->offsets.data(),
+                   transpose->sources.data()};
+}
+
+// @return id of the vertex with the given label, -1 if not found
+VertexId FrozenGraph::id(const string &label) const {
+  int low = 0;
+  int high = verticesSize() - 1;
+  while (low <= high) {
+    int mid = low + (high - low) / 2;
+    int cmp = label.compare(0, string::npos, &labelChars[labelOffsets[mid]],
+                            labelOffsets[mid + 1] - labelOffsets[mid]);
+    if (cmp == 0) {
+      return mid;
+    }
+    if (cmp < 0) {
+      high = mid - 1;
+    } else {
+      low = mid + 1;
+    }
+  }
+  return -1;
+}
+
+// @return label of the vertex with the given id
+string FrozenGraph::label(VertexId id) const {
+  return string(labelChars + labelOffsets[id],
+                labelChars + labelOffsets[id + 1]);
+}
+
+// @return true if the snapshot was taken from an undirected graph
+bool FrozenGraph::isDirectional() const { return directional; }
+
+// @return true if vertex is in the graph
+bool FrozenGraph::contains(const string &label) const {
+  return id(label) != -1;
+}
+
+// @return total number of vertices
+int FrozenGraph::verticesSize() const { return vertexCount; }
+
+// @return total number of edges
+int FrozenGraph::edgesSize() const { return edgeCount; }
+
+// @return number of edges from given vertex, -1 if vertex not found
+int FrozenGraph::vertexDegree(const string &label) const {
+  VertexId v = id(label);
+  return v == -1 ? -1 : offsets[v + 1] - offsets[v];
+}
+
+// @return string representing edges and weights, "" if vertex not found
+// rows are stored in label order, so no sorting is needed
+string FrozenGraph::getEdgesAsString(const string &label) const {
+  string rtn;
+  VertexId v = id(label);
+  if (v == -1 || offsets[v] == offsets[v + 1]) {
+    return rtn;
+  }
+  for (int i = offsets[v]; i < offsets[v + 1]; ++i) {
+    rtn += this->label(targets[i]) + "(" + to_string(weights[i]) + "),";
+  }
+  rtn.pop_back();
+  return rtn;
+}
+
+// depth-first traversal starting from given startLabel
+void FrozenGraph::dfs(const string &startLabel,
+                      void visit(const string &label)) const {
+  VertexId start = id(startLabel);
+  if (start != -1) {
+    dfsSearch(CsrView{*this}, vector<int>(1, start),
+              [this, visit](VertexId v) { visit(label(v)); });
+  }
+}
+
+// depth-first search from startLabel without visiting anything
+DfsResult FrozenGraph::dfsTree(const string &startLabel) const {
+  VertexId start = id(startLabel);
+  if (start == -1) {
+    return DfsResult(verticesSize());
+  }
+  return dfsSearch(CsrView{*this}, vector<int>(1, start), [](VertexId) {});
+}
+
+// depth-first search forest over the whole graph, roots in label order
+DfsResult FrozenGraph::dfsForest() const {
+  vector<int> roots(verticesSize());
+  for (VertexId i = 0; i < verticesSize(); ++i) {
+    roots[i] = i;
+  }
+  return dfsSearch(CsrView{*this}, roots, [](VertexId) {});
+}
+
+// strongly connected components, ids in a topological order of the
+// condensation
+SccResult FrozenGraph::stronglyConnectedComponents(int threads) const {
+  if (threads == 1) {
+    return tarjanScc(CsrView{*this});
+  }
+  return parallelScc(outEdges(), inEdges(), threads);
+}
+
+// breadth-first traversal starting from startLabel
+void FrozenGraph::bfs(const string &startLabel,
+                      void visit(const string &label)) const {
+  int start = id(startLabel);
+  if (start == -1) {
+    return;
+  }
+  vector<bool> visited(verticesSize(), false);
+  vector<int> q;
+  q.push_back(start);
+  visited[start] = true;
+  for (size_t head = 0; head < q.size(); ++head) {
+    int curr = q[head];
+    visit(label(curr));
+    for (int i = offsets[curr]; i < offsets[curr + 1]; ++i) {
+      if (!visited[targets[i]]) {
+        visited[targets[i]] = true;
+        q.push_back(targets[i]);
+      }
+    }
+  }
+}
+
+// direction-optimizing breadth-first search for hop counts
+BfsResult FrozenGraph::bfsLevels(const string &startLabel,
+                                 int threads) const {
+  VertexId start = id(startLabel);
+  if (start == -1) {
+    return BfsResult();
+  }
+  return levelBfs(outEdges(), inEdges(), start, threads);
+}
+
+// find the total weight to every vertex reachable from startLabel
+pair<map<string, int>, map<string, string>>
+FrozenGraph::dijkstra(const string &startLabel,
+                      const DijkstraOptions &options) const {
+  map<string, int> weights;
+  map<string, string> previous;
+  int start = id(startLabel);
+  if (start == -1) {
+    return make_pair(weights, previous);
+  }
+  vector<int> dist;
+  vector<int> prev;
+  dijkstraSearch(CsrView{*this}, start, -1, options, dist, prev);
+  for (int i = 0; i < verticesSize(); ++i) {
+    if (i != start && prev[i] != -1) {
+      weights[label(i)] = dist[i];
+      previous[label(i)] = label(prev[i]);
+    }
+  }
+  return make_pair(weights, previous);
+}
+
+// shortest path between two vertices, stops once "to" is settled
+pair<int, vector<string>>
+FrozenGraph::shortestPath(const string &from, const string &to,
+                          const DijkstraOptions &options) const {
+  vector<string> path;
+  int source = id(from);
+  int target = id(to);
+  if (source == -1 || target == -1) {
+    return make_pair(-1, path);
+  }
+  vector<int> dist;
+  vector<int> prev;
+  dijkstraSearch(CsrView{*this}, source, target, options, dist, prev);
+  if (dist[target] == INT_MAX) {
+    return make_pair(-1, path);
+  }
+  for (int v = target; v != -1; v = prev[v]) {
+    path.push_back(label(v));
+  }
+  reverse(path.begin(), path.end());
+  return make_pair(dist[target], path);
+}
+
+// shortest path cost from every source to every target
+DistanceMatrix<int>
+FrozenGraph::distanceMatrix(const vector<string> &sources,
+                            const vector<string> &targets,
+                            int threads) const {
+  vector<VertexId> sourceIds;
+  vector<VertexId> targetIds;
+  for (auto const &source : sources) {
+    sourceIds.push_back(id(source));
+  }
+  for (auto const &target : targets) {
+    targetIds.push_back(id(target));
+  }
+  DistanceMatrix<int> matrix =
+      distanceSearch(CsrView{*this}, sourceIds, targetIds, threads);
+  for (int &distance : matrix.distances) {
+    if (distance == INT_MAX) {
+      distance = -1;
+    }
+  }
+  return matrix;
+}
+
+// minimum spanning tree using Prim's algorithm
+// equal weights are taken by (from, to) in label order, so with ties
+// the edges visited may differ from Graph::mstPrim, the length does not
+int FrozenGraph::mstPrim(const string &startLabel,
+                         void visit(const string &from, const string &to,
+                                    int weight)) const {
+  int start = id(startLabel);
+  if (directional || start == -1) {
+    return -1;
+  }
+  // (weight, from, to) ordered by lowest weight
+  typedef pair<int, pair<int, int>> Candidate;
+  priority_queue<Candidate, vector<Candidate>, greater<Candidate>> edges;
+  vector<bool> visited(verticesSize(), false);
+  visited[start] = true;
+  for (int i = offsets[start]; i < offsets[start + 1]; ++i) {
+    edges.push(make_pair(weights[i], make_pair(start, targets[i])));
+  }
+  int weight = 0;
+  while (!edges.empty()) {
+    Candidate curr = edges.top();
+    edges.pop();
+    int to = curr.second.second;
+    if (!visited[to]) {
+      weight += curr.first;
+      visited[to] = true;
+      visit(label(curr.second.first), label(to), curr.first);
+      for (int i = offsets[to]; i < offsets[to + 1]; ++i) {
+        if (!visited[targets[i]]) {
+          edges.push(make_pair(weights[i], make_pair(to, targets[i])));
+        }
+      }
+    }
+  }
+  return weight;
+}
+
+// minimum spanning tree using Kruskal's algorithm
+int FrozenGraph::mstKruskal(const string &startLabel,
+                            void visit(const string &from, const string &to,
+                                       int weight)) const {
+  int start = id(startLabel);
+  if (directional || start == -1) {
+    return -1;
+  }
+  vector<MstEdge<int>> tree;
+  int weight = kruskalSearch(CsrView{*this}, start, tree);
+  for (auto const &edge : tree) {
+    visit(label(edge.from), label(edge.to), edge.weight);
+  }
+  return weight;
+}
+
+// minimum spanning forest using a parallel Boruvka
+vector<int>
+FrozenGraph::mstParallel(void visit(const string &from, const string &to,
+                                    int weight),
+                         int threads) const {
+  vector<int> totals;
+  if (directional) {
+    return totals;
+  }
+  vector<MstEdge<int>> forest;
+  totals = boruvkaForest(CsrView{*this}, threads, forest);
+  for (auto const &edge : forest) {
+    visit(label(edge.from), label(edge.to), edge.weight);
+  }
+  return totals;
+}
@@ -0,0 +1,222 @@
+/**
+ * A FrozenGraph is an immutable snapshot of a Graph for read-heavy use.
+ * Vertices are packed into dense integer ids in label order, and edges
+ * are stored in compressed sparse row (CSR) form: the edges leaving
+ * vertex i are targets[offsets[i]] .. targets[offsets[i + 1] - 1], with
+ * the matching weights at the same positions. Because ids follow label
+ * order, every row is already sorted by label and traversals never sort.
+ * The public methods mirror the read-only methods of Graph.
+ *
+ * A snapshot can be saved with writeBinary and loaded with readBinary.
+ * The binary file holds the same arrays laid out back to back, so
+ * readBinary maps the file into memory and traversals read straight from
+ * the mapped pages without parsing or copying anything.
+ */
+
+#ifndef FROZENGRAPH_H
+#define FROZENGRAPH_H
+
+#include "bfs.h"
+#include "dfs.h"
+#include "labeltable.h"
+#include "scc.h"
+#include "shortestpath.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+template <typename W> class BasicGraph;
+using Graph = BasicGraph<int>;
+
+class FrozenGraph {
+private:
+  // arrays built in memory by the constructor, not used when mapped
+  struct Storage {
+    vector<int> labelOffsets;
+    vector<char> labelChars;
+    vector<int> offsets;
+    vector<int> targets;
+    vector<int> weights;
+  };
+
+  bool directional;
+  int vertexCount;
+  int edgeCount;
+  // label of vertex i is labelChars[labelOffsets[i] .. labelOffsets[i+1])
+  const int *labelOffsets;
+  const char *labelChars;
+  // CSR adjacency, row i is [offsets[i], offsets[i+1])
+  const int *offsets;
+  const int *targets;
+  const int *weights;
+  // owner of the arrays, either storage or a mapped file
+  Storage storage;
+  void *mapping;
+  size_t mappingSize;
+  // in-edges of a directed graph, built on first use by inEdges
+  struct Transpose {
+    vector<int> offsets;
+    vector<int> sources;
+  };
+  mutable unique_ptr<Transpose> transpose;
+  mutable unique_ptr<mutex> transposeLock;
+
+  // point the arrays at storage
+  void useStorage();
+
+  // unmap the file if one is mapped
+  void unmap();
+
+  // @return the out-edges as CSR arrays
+  CsrArrays outEdges() const;
+
+  // @return the in-edges as CSR arrays, the out-edges if undirected
+  CsrArrays inEdges() const;
+
+  // integer id view of the adjacency used by the search engines
+  struct CsrView;
+
+public:
+  // empty graph, use readBinary to fill it
+  FrozenGraph();
+
+  // snapshot of the vertices and edges currently in graph
+  explicit FrozenGraph(const Graph &graph);
+
+  // copy not allowed
+  FrozenGraph(const FrozenGraph &other) = delete;
+
+  // move allowed, so Graph::freeze can return by value
+  FrozenGraph(FrozenGraph &&other) noexcept;
+
+  // assignment not allowed
+  FrozenGraph &operator=(const FrozenGraph &other) = delete;
+
+  // move assignment allowed
+  FrozenGraph &operator=(FrozenGraph &&other) noexcept;
+
+  /** destructor, unmaps the file if the graph was read with readBinary */
+  ~FrozenGraph();
+
+  // Write the graph in the binary format described in frozengraph.cpp
+  // @return true if file successfully written
+  bool writeBinary(const string &filename) const;
+
+  // Map a file written by writeBinary, replacing the current contents
+  // The file must not be modified while it is mapped
+  // @return true if file successfully mapped
+  bool readBinary(const string &filename);
+
+  // @return true if the snapshot was taken from an undirected graph
+  bool isDirectional() const;
+
+  // @return true if vertex is in the graph
+  bool contains(const string &label) const;
+
+  // @return id of the vertex with the given label, -1 if not found
+  // ids follow label order, so they usually differ from the Graph's ids
+  VertexId id(const string &label) const;
+
+  // @return label of the vertex with the given id
+  string label(VertexId id) const;
+
+  // @return total number of vertices
+  int verticesSize() const;
+
+  // @return total number of edges, same counting as Graph::edgesSize
+  int edgesSize() const;
+
+  // @return number of edges from given vertex, -1 if vertex not found
+  int vertexDegree(const string &label) const;
+
+  // @return string representing edges and weights, "" if vertex not found
+  // A-3->B, A-5->C should return B(3),C(5)
+  string getEdgesAsString(const string &label) const;
+
+  // depth-first traversal starting from given startLabel
+  void dfs(const string &startLabel, void visit(const string &label)) const;
+
+  // depth-first search from startLabel without visiting anything
+  // @return pre/post-order numbers, discovery/finish times and parents
+  // by vertex id, all -1 for vertices not reached
+  DfsResult dfsTree(const string &startLabel) const;
+
+  // depth-first search forest over the whole graph, a new search starts
+  // from each vertex not yet reached, in label order
+  // @return pre/post-order numbers, discovery/finish times and parents
+  DfsResult dfsForest() const;
+
+  // strongly connected components, ids in a topological order of the
+  // condensation, see scc.h
+  // threads == 1 runs Tarjan's algorithm, anything else the parallel
+  // forward-backward search on that many threads (0 = one per core)
+  // @return component of every vertex, by id, and the condensation DAG
+  SccResult stronglyConnectedComponents(int threads = 1) const;
+
+  // breadth-first traversal starting from startLabel
+  void bfs(const string &startLabel, void visit(const string &label)) const;
+
+  // breadth-first search for hop counts from startLabel, switching
+  // between top-down and bottom-up steps and using threads for each
+  // level (0 = one per core); faster than bfs on large graphs, but the
+  // result is by vertex id rather than a visit order by label
+  // @return hop distance and parent of every id, both empty if
+  // startLabel is not found
+  BfsResult bfsLevels(const string &startLabel, int threads = 0) const;
+
+  // dijkstra's algorithm to find shortest distance to all other vertices
+  // @return a pair made up of two map objects, Weights and Previous
+  pair<map<string, int>, map<string, string>>
+  dijkstra(const string &startLabel,
+           const DijkstraOptions &options = DijkstraOptions()) const;
+
+  // shortest path between two vertices, search stops once "to" is reached
+  // @return a pair of the path cost and the labels on the path,
+  // {-1, {}} if either vertex is missing or unreachable
+  pair<int, vector<string>>
+  shortestPath(const string &from, const string &to,
+               const DijkstraOptions &options = DijkstraOptions()) const;
+
+  // shortest path cost from every source to every target, the sources
+  // are shared out among threads (0 = one per core)
+  // Much faster than one dijkstra per source: no maps are built, each
+  // search stops once all targets are settled and repeated sources are
+  // searched once
+  // @return matrix with at(i, j) the cost from sources[i] to targets[j],
+  // -1 if either vertex is missing or targets[j] is unreachable
+  DistanceMatrix<int> distanceMatrix(const vector<string> &sources,
+                                     const vector<string> &targets,
+                                     int threads = 0) const;
+
+  // minimum spanning tree using Prim's algorithm
+  // ONLY works for NONDIRECTED graphs
+  // equal weights are taken by (from, to) in label order, so with ties
+  // the edges visited may differ from Graph::mstPrim, the length does not
+  // @return length of the minimum spanning tree or -1 if start vertex not
+  int mstPrim(const string &startLabel,
+              void visit(const string &from, const string &to,
+                         int weight)) const;
+
+  // minimum spanning tree using Kruskal's algorithm
+  // ONLY works for NONDIRECTED graphs
+  // @return length of the minimum spanning tree or -1 if start vertex not
+  int mstKruskal(const string &startLabel,
+                 void visit(const string &from, const string &to,
+                            int weight)) const;
+
+  // minimum spanning forest of the whole graph, every component included,
+  // using Boruvka's algorithm spread over threads (0 = one per core)
+  // ONLY works for NONDIRECTED graphs
+  // visit is called on the calling thread once all threads are done
+  // @return total weight of each component's tree, in order of the
+  // component's first vertex label, empty for directed graphs
+  vector<int> mstParallel(void visit(const string &from, const string &to,
+                                     int weight),
+                          int threads = 0) const;
+};
+
+#endif // FROZENGRAPH_H
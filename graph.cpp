@@ -1,360 +1,995 @@
 #include "graph.h"
+#include "frozengraph.h"
+#include "instrument.h"
+#include "mst.h"
+#include "parallel.h"
 #include <algorithm>
 #include <climits>
+#include <cctype>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <sstream>
 #include <queue>
-#include <stack>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 using namespace std;
 
 // constructor, empty graph
-// directionalEdges defaults to true
-Graph::Graph(bool directionalEdges) { directional = directionalEdges; }
+// directionalEdges defaults to true, memory comes from an arena by default
+template <typename W>
+BasicGraph<W>::BasicGraph(bool directionalEdges, AllocationPolicy policy)
+    : edgeCount(0), totalWeight(0), degreeHistogram(1, 0) {
+  directional = directionalEdges;
+  if (policy == AllocationPolicy::Arena) {
+    arena.reset(new Arena());
+  }
+}
 
 // destructor
-Graph::~Graph() {
-  for (auto const &curr : vertices) {
-    delete curr.second;
+// with an arena the vertices are not destroyed one by one, releasing
+// the arena frees every vertex and edge at once
+template <typename W>
+BasicGraph<W>::~BasicGraph() {
+  if (!arena) {
+    for (auto const &curr : vertices) {
+      delete curr;
+    }
   }
   vertices.clear();
 }
 
 // @return total number of vertices
-int Graph::verticesSize() const { return vertices.size(); }
+template <typename W>
+int BasicGraph<W>::verticesSize() const { return vertices.size(); }
+
+// @return true if edges are directed
+template <typename W>
+bool BasicGraph<W>::isDirectional() const { return directional; }
 
 // @return total number of edges
-int Graph::edgesSize() const {
-  map<Vertex *, set<Vertex *>> visited;
-  int total = 0;
-  for (auto const &i : vertices) {
-    if (directional) {
-      total += i.second->connected.size();
-    } else {
-      for (auto const &j : i.second->connected) {
-        if (visited.count(i.second) == 0 ||
-            visited[i.second].count(j.first) == 0) {
-          visited[i.second].insert(j.first);
-          visited[j.first].insert(i.second);
-          total++;
-        }
-      }
-    }
+template <typename W>
+int BasicGraph<W>::edgesSize() const { return edgeCount; }
+
+// @return vertex, edge, weight and degree counters
+template <typename W>
+BasicGraphStats<W> BasicGraph<W>::stats() const {
+  BasicGraphStats<W> result;
+  result.vertices = verticesSize();
+  result.edges = edgeCount;
+  result.totalWeight = totalWeight;
+  result.maxDegree = degreeHistogram.size() - 1;
+  result.degreeHistogram = degreeHistogram;
+  return result;
+}
+
+// move one vertex between histogram buckets, trailing empty buckets are
+// dropped so the last bucket is always the largest degree in use
+template <typename W>
+void BasicGraph<W>::moveDegree(int oldDegree, int delta) {
+  int newDegree = oldDegree + delta;
+  if (newDegree >= static_cast<int>(degreeHistogram.size())) {
+    degreeHistogram.resize(newDegree + 1, 0);
   }
-  return total;
+  --degreeHistogram[oldDegree];
+  ++degreeHistogram[newDegree];
+  while (degreeHistogram.size() > 1 && degreeHistogram.back() == 0) {
+    degreeHistogram.pop_back();
+  }
+}
+
+// @return number of edges from given vertex, -1 if vertex not found
+template <typename W>
+int BasicGraph<W>::vertexDegree(const string &label) const {
+  return vertexDegree(id(label));
+}
+
+// @return number of edges from given vertex, -1 if id not valid
+template <typename W>
+int BasicGraph<W>::vertexDegree(VertexId id) const {
+  return id >= 0 && id < verticesSize() ? vertices[id]->connected.size() : -1;
+}
+
+// @return number of edges into given vertex, -1 if vertex not found
+template <typename W>
+int BasicGraph<W>::inDegree(const string &label) const {
+  return inDegree(id(label));
+}
+
+// @return number of edges into given vertex, -1 if id not valid
+template <typename W>
+int BasicGraph<W>::inDegree(VertexId id) const {
+  return id >= 0 && id < verticesSize() ? vertices[id]->inDegree : -1;
 }
 
 // @return number of edges from given vertex, -1 if vertex not found
-int Graph::vertexDegree(const string &label) const {
-  return vertices.count(label) == 1 ? vertices.at(label)->connected.size() : -1;
+template <typename W>
+int BasicGraph<W>::outDegree(const string &label) const {
+  return vertexDegree(id(label));
 }
 
+// @return number of edges from given vertex, -1 if id not valid
+template <typename W>
+int BasicGraph<W>::outDegree(VertexId id) const { return vertexDegree(id); }
+
 // @return true if vertex added, false if it already is in the graph
-bool Graph::add(const string &label) {
-  if (vertices.count(label) == 1) {
+template <typename W>
+bool BasicGraph<W>::add(const string &label) {
+  if (contains(label)) {
+    return false;
+  }
+  findOrAdd(label);
+  return true;
+}
+
+// @return id of the vertex with the given label, created if necessary
+template <typename W>
+VertexId BasicGraph<W>::findOrAdd(const string &label) {
+  VertexId id = labels.intern(label);
+  if (id == verticesSize()) {
+    ArenaAllocator<Vertex> alloc(arena.get());
+    Vertex *vertex = alloc.allocate(1);
+    new (vertex) Vertex(arena.get());
+    vertices.push_back(vertex);
+    ++degreeHistogram[0];
+  }
+  return id;
+}
+
+namespace {
+// orders an edge before the edges to vertex to, for binary searches
+template <typename W>
+bool edgeBefore(const AdjacentEdge<W> &edge, VertexId to) {
+  return edge.first < to;
+}
+
+// orders edges by the id of the other end
+template <typename W>
+bool byTarget(const AdjacentEdge<W> &a, const AdjacentEdge<W> &b) {
+  return a.first < b.first;
+}
+
+// @return weight as text, 2.5 rather than to_string's 2.500000
+template <typename W> string weightToString(W weight) {
+  if (!is_floating_point<W>::value) {
+    return to_string(weight);
+  }
+  ostringstream out;
+  out << weight;
+  return out.str();
+}
+} // namespace
+
+// @return position of the edge to to in connected, or of the first
+// edge to a larger id if there is none
+template <typename W>
+typename BasicGraph<W>::Adjacency::iterator
+BasicGraph<W>::findEdge(Adjacency &connected, VertexId to) {
+  return lower_bound(connected.begin(), connected.end(), to, edgeBefore<W>);
+}
+
+// make room in connected for count more edges
+// grows by half instead of doubling, most vertices have few edges and
+// the unused room is paid for on every one of them
+template <typename W>
+void BasicGraph<W>::reserveEdge(Adjacency &connected, size_t count) {
+  size_t needed = connected.size() + count;
+  if (needed > connected.capacity()) {
+    connected.reserve(max(needed, connected.size() + connected.size() / 2 +
+                                      2));
+  }
+}
+
+// make room for the edges about to be added in one allocation per vertex
+// growing a vertex once, rather than through every size on the way,
+// leaves no outgrown blocks on the arena's free lists
+template <typename W>
+void BasicGraph<W>::reserveEdges(vector<VertexId> &ends) {
+  sort(ends.begin(), ends.end());
+  for (size_t begin = 0, end = 0; begin < ends.size(); begin = end) {
+    while (end < ends.size() && ends[end] == ends[begin]) {
+      ++end;
+    }
+    reserveEdge(vertices[ends[begin]]->connected, end - begin);
+  }
+}
+
+// add an edge to to with weight to connected, keeping it ordered
+// the edges after it move up one place
+// @return false if connected already has an edge to to
+template <typename W>
+bool BasicGraph<W>::insertEdge(Adjacency &connected, VertexId to,
+                               W weight) {
+  auto at = findEdge(connected, to);
+  if (at != connected.end() && at->first == to) {
     return false;
   }
-  vertices[label] = new Vertex{label, {}};
+  size_t position = at - connected.begin();
+  reserveEdge(connected);
+  connected.insert(connected.begin() + position,
+                   AdjacentEdge<W>(to, weight));
   return true;
 }
 
+// remove the edge to to from connected
+// @return its weight, connected must have it
+template <typename W>
+W BasicGraph<W>::eraseEdge(Adjacency &connected, VertexId to) {
+  auto at = findEdge(connected, to);
+  W weight = at->second;
+  connected.erase(at);
+  return weight;
+}
+
 /** return true if vertex already in graph */
-bool Graph::contains(const string &label) const {
-  return vertices.count(label) == 1;
+template <typename W>
+bool BasicGraph<W>::contains(const string &label) const {
+  return id(label) != -1;
+}
+
+// @return id of the vertex with the given label, -1 if not found
+template <typename W>
+VertexId BasicGraph<W>::id(const string &label) const {
+  return labels.find(label);
+}
+
+// @return label of the vertex with the given id
+template <typename W>
+const string &BasicGraph<W>::label(VertexId id) const {
+  return labels.label(id);
+}
+
+// @return the edges of a vertex sorted by the label of the other end
+// sorted once and kept until the edges of the vertex change
+// the lock keeps two const traversals from sorting the same vertex at once
+template <typename W>
+const typename BasicGraph<W>::SortedAdjacency &
+BasicGraph<W>::sortedEdges(VertexId id) const {
+  const Vertex &vertex = *vertices[id];
+  if (!vertex.sortedValid.load(memory_order_acquire)) {
+    lock_guard<mutex> guard(sortedLock);
+    if (!vertex.sortedValid.load(memory_order_relaxed)) {
+      vertex.sorted.assign(vertex.connected.begin(), vertex.connected.end());
+      sort(vertex.sorted.begin(), vertex.sorted.end(),
+           [this](const typename SortedAdjacency::value_type &a,
+                  const typename SortedAdjacency::value_type &b) {
+             return label(a.first) < label(b.first);
+           });
+      vertex.sortedValid.store(true, memory_order_release);
+    }
+  }
+  return vertex.sorted;
+}
+
+// drop the sorted edges of a vertex after its edges changed
+// the vector keeps its memory for the next sort
+template <typename W>
+void BasicGraph<W>::edgesChanged(VertexId id) {
+  vertices[id]->sortedValid.store(false, memory_order_relaxed);
+}
+
+// tell the observers the edge from -> to was added
+template <typename W>
+void BasicGraph<W>::notifyAdded(VertexId from, VertexId to, W weight) {
+  for (BasicGraphObserver<W> *observer : observers) {
+    observer->edgeAdded(from, to, weight);
+  }
+}
+
+// tell the observers the edge from -> to was removed
+template <typename W>
+void BasicGraph<W>::notifyRemoved(VertexId from, VertexId to, W weight) {
+  for (BasicGraphObserver<W> *observer : observers) {
+    observer->edgeRemoved(from, to, weight);
+  }
+}
+
+// tell observer about every edge added or removed from now on
+template <typename W>
+void BasicGraph<W>::addObserver(BasicGraphObserver<W> *observer) {
+  observers.push_back(observer);
+}
+
+// stop telling observer about changes
+// @return true if it was observing
+template <typename W>
+bool BasicGraph<W>::removeObserver(BasicGraphObserver<W> *observer) {
+  auto found = find(observers.begin(), observers.end(), observer);
+  if (found == observers.end()) {
+    return false;
+  }
+  observers.erase(found);
+  return true;
 }
 
 // @return string representing edges and weights, "" if vertex not found
 // A-3->B, A-5->C should return B(3),C(5)
-string Graph::getEdgesAsString(const string &label) const {
+template <typename W>
+string BasicGraph<W>::getEdgesAsString(const string &label) const {
+  return getEdgesAsString(id(label));
+}
+
+// @return string representing edges and weights, "" if id not valid
+template <typename W>
+string BasicGraph<W>::getEdgesAsString(VertexId id) const {
   string rtn;
-  if (vertices.count(label) == 0 || vertices.at(label)->connected.empty()) {
+  if (vertexDegree(id) <= 0) {
     return rtn;
   }
-  // push string rep into set w/ comparator lambda
-  auto comp = [](pair<Vertex *, int> a, pair<Vertex *, int> b) {
-    return a.first->val < b.first->val;
-  };
-  set<pair<Vertex *, int>, decltype(comp)> connected(
-      vertices.at(label)->connected.begin(),
-      vertices.at(label)->connected.end(), comp);
-  // Print the sorted value
-  for (auto &i : connected) {
-    rtn += i.first->val + "(" + to_string(i.second) + "),";
+  // Print the edges sorted by label
+  for (auto const &i : sortedEdges(id)) {
+    rtn += label(i.first) + "(" + weightToString(i.second) + "),";
   }
   rtn.pop_back();
   return rtn;
 }
 
 // @return true if successfully connected
-bool Graph::connect(const string &from, const string &to, int weight) {
+template <typename W>
+bool BasicGraph<W>::connect(const string &from, const string &to,
+                            W weight) {
   if (from == to) {
     return false;
   }
-  if (vertices.count(from) == 0) {
-    vertices[from] = new Vertex{from, {}};
-  }
-  if (vertices.count(to) == 0) {
-    vertices[to] = new Vertex{to, {}};
-  }
-  if (vertices[from]->connected.count(vertices[to]) == 1) {
+  // from gets its id first, as in readFileParallel and connectBatch
+  VertexId fromId = findOrAdd(from);
+  return connect(fromId, findOrAdd(to), weight);
+}
+
+// connect two existing vertices, same rules as above
+template <typename W>
+bool BasicGraph<W>::connect(VertexId from, VertexId to, W weight) {
+  if (from == to || vertexDegree(from) == -1 || vertexDegree(to) == -1 ||
+      !insertEdge(vertices[from]->connected, to, weight)) {
     return false;
   }
-  vertices[from]->connected[vertices[to]] = weight;
+  moveDegree(vertices[from]->connected.size() - 1, 1);
+  edgesChanged(from);
+  ++vertices[to]->inDegree;
   if (!directional) {
-    vertices[to]->connected[vertices[from]] = weight;
+    moveDegree(vertices[to]->connected.size(), 1);
+    insertEdge(vertices[to]->connected, from, weight);
+    edgesChanged(to);
+    ++vertices[from]->inDegree;
   }
+  ++edgeCount;
+  totalWeight += weight;
+  notifyAdded(from, to, weight);
   return true;
 }
 
 // disconnects two vertex's from each other
-bool Graph::disconnect(const string &from, const string &to) {
-  if (vertices.count(from) == 0 || vertices.count(to) == 0) {
+template <typename W>
+bool BasicGraph<W>::disconnect(const string &from, const string &to) {
+  return disconnect(id(from), id(to));
+}
+
+// disconnects two vertices given by id
+template <typename W>
+bool BasicGraph<W>::disconnect(VertexId from, VertexId to) {
+  if (vertexDegree(from) == -1 || vertexDegree(to) == -1) {
     return false;
   }
-  if (vertices[from]->connected.count(vertices[to]) == 0) {
+  Adjacency &connected = vertices[from]->connected;
+  auto edge = findEdge(connected, to);
+  if (edge == connected.end() || edge->first != to) {
     return false;
   }
-  vertices[from]->connected.erase(vertices[to]);
+  W weight = edge->second;
+  totalWeight -= weight;
+  --edgeCount;
+  connected.erase(edge);
+  edgesChanged(from);
+  moveDegree(connected.size() + 1, -1);
+  --vertices[to]->inDegree;
   if (!directional) {
-    vertices[to]->connected.erase(vertices[from]);
+    eraseEdge(vertices[to]->connected, from);
+    edgesChanged(to);
+    moveDegree(vertices[to]->connected.size() + 1, -1);
+    --vertices[from]->inDegree;
   }
+  notifyRemoved(from, to, weight);
   return true;
 }
 
-// depth-first traversal starting from given startLabel
-void Graph::dfs(const string &startLabel, void visit(const string &label)) {
-  if (vertices.count(startLabel) == 1) {
-    set<Vertex *> visited;
-    visited.insert(vertices[startLabel]);
-    dfsTraverse(visited, vertices[startLabel], visit);
-  }
+namespace {
+// an edge of a batch with its vertex ids, ordered so that all the edges
+// of one vertex are next to each other
+// for undirected graphs from is the smaller id
+struct BatchEdge {
+  VertexId from;
+  VertexId to;
+  int index; // position in the batch
+};
+
+// sort by vertex pair, edges between the same pair keep batch order
+void groupBatch(vector<BatchEdge> &batch) {
+  stable_sort(batch.begin(), batch.end(),
+              [](const BatchEdge &a, const BatchEdge &b) {
+                return a.from < b.from || (a.from == b.from && a.to < b.to);
+              });
 }
+} // namespace
 
-// recursive method for DFS traversal
-void Graph::dfsTraverse(set<Vertex *> &visited, Vertex *curr,
-                        void visit(const string &label)) {
-  visit(curr->val);
-  auto comp = [](pair<Vertex *, int> a, pair<Vertex *, int> b) {
-    return a.first->val < b.first->val;
-  };
-  set<pair<Vertex *, int>, decltype(comp)> connected(
-      curr->connected.begin(), curr->connected.end(), comp);
-  for (auto const &i : connected) {
-    if (visited.count(i.first) == 0) {
-      visited.insert(i.first);
-      dfsTraverse(visited, i.first, visit);
+// add many edges at once, same outcome as connect on each edge in order
+template <typename W>
+vector<bool>
+BasicGraph<W>::connectBatch(const vector<BasicEdgeUpdate<W>> &edges) {
+  vector<bool> done(edges.size(), false);
+  vector<BatchEdge> batch;
+  batch.reserve(edges.size());
+  const string *lastLabel = nullptr;
+  VertexId lastId = -1;
+  for (size_t i = 0; i < edges.size(); ++i) {
+    const BasicEdgeUpdate<W> &edge = edges[i];
+    if (edge.from == edge.to) {
+      continue; // like connect, a self-loop does not add its vertex
+    }
+    if (lastLabel == nullptr || *lastLabel != edge.from) {
+      lastLabel = &edge.from;
+      lastId = findOrAdd(edge.from);
+    }
+    VertexId to = findOrAdd(edge.to);
+    if (directional || lastId < to) {
+      batch.push_back({lastId, to, static_cast<int>(i)});
+    } else {
+      batch.push_back({to, lastId, static_cast<int>(i)});
+    }
+  }
+  groupBatch(batch);
+  vector<VertexId> ends;
+  ends.reserve(directional ? batch.size() : 2 * batch.size());
+  for (auto const &edge : batch) {
+    ends.push_back(edge.from);
+    if (!directional) {
+      ends.push_back(edge.to);
     }
   }
+  reserveEdges(ends);
+  for (size_t begin = 0; begin < batch.size();) {
+    VertexId from = batch[begin].from;
+    Adjacency &connected = vertices[from]->connected;
+    int oldDegree = connected.size();
+    // targets are ascending, so new edges are appended in order and
+    // merged with the old ones once, instead of each moving the edges
+    // after it; until then observers see them unordered at the end
+    size_t end = begin;
+    for (; end < batch.size() && batch[end].from == from; ++end) {
+      VertexId to = batch[end].to;
+      W weight = edges[batch[end].index].weight;
+      auto old = lower_bound(connected.begin(),
+                             connected.begin() + oldDegree, to,
+                             edgeBefore<W>);
+      if ((old != connected.begin() + oldDegree && old->first == to) ||
+          (static_cast<int>(connected.size()) > oldDegree &&
+           connected.back().first == to)) {
+        continue; // already connected
+      }
+      reserveEdge(connected);
+      connected.emplace_back(to, weight);
+      done[batch[end].index] = true;
+      ++vertices[to]->inDegree;
+      if (!directional) {
+        // to > from, so its edges are not being merged
+        moveDegree(vertices[to]->connected.size(), 1);
+        insertEdge(vertices[to]->connected, from, weight);
+        edgesChanged(to);
+        ++vertices[from]->inDegree;
+      }
+      ++edgeCount;
+      totalWeight += weight;
+      edgesChanged(from);
+      notifyAdded(from, to, weight);
+    }
+    if (static_cast<int>(connected.size()) != oldDegree) {
+      inplace_merge(connected.begin(), connected.begin() + oldDegree,
+                    connected.end(), byTarget<W>);
+      moveDegree(oldDegree, connected.size() - oldDegree);
+    }
+    begin = end;
+  }
+  return done;
 }
 
-// breadth-first traversal starting from startLabel
-void Graph::bfs(const string &startLabel, void visit(const string &label)) {
-  set<Vertex *> visited;
-  queue<Vertex *> q;
-  q.push(vertices[startLabel]);
-  visited.insert(vertices[startLabel]);
-  Vertex *curr;
-  auto comp = [](pair<Vertex *, int> a, pair<Vertex *, int> b) {
-    return a.first->val < b.first->val;
-  };
-  while (!q.empty()) {
-    curr = q.front();
-    q.pop();
-    visit(curr->val);
-    set<pair<Vertex *, int>, decltype(comp)> connected(
-        curr->connected.begin(), curr->connected.end(), comp);
-    for (auto const &i : connected) {
-      if (visited.count(i.first) == 0) {
-        q.push(i.first);
-        visited.insert(i.first);
+// remove many edges at once, same outcome as disconnect on each in order
+template <typename W>
+vector<bool>
+BasicGraph<W>::disconnectBatch(const vector<BasicEdgeUpdate<W>> &edges) {
+  vector<bool> done(edges.size(), false);
+  vector<BatchEdge> batch;
+  batch.reserve(edges.size());
+  const string *lastLabel = nullptr;
+  VertexId lastId = -1;
+  for (size_t i = 0; i < edges.size(); ++i) {
+    const BasicEdgeUpdate<W> &edge = edges[i];
+    if (lastLabel == nullptr || *lastLabel != edge.from) {
+      lastLabel = &edge.from;
+      lastId = id(edge.from);
+    }
+    VertexId to = id(edge.to);
+    if (lastId == -1 || to == -1 || lastId == to) {
+      continue;
+    }
+    if (directional || lastId < to) {
+      batch.push_back({lastId, to, static_cast<int>(i)});
+    } else {
+      batch.push_back({to, lastId, static_cast<int>(i)});
+    }
+  }
+  groupBatch(batch);
+  for (size_t begin = 0; begin < batch.size();) {
+    VertexId from = batch[begin].from;
+    Adjacency &connected = vertices[from]->connected;
+    int oldDegree = connected.size();
+    size_t end = begin;
+    for (; end < batch.size() && batch[end].from == from; ++end) {
+      VertexId to = batch[end].to;
+      auto edge = findEdge(connected, to);
+      if (edge == connected.end() || edge->first != to) {
+        continue; // never connected or already removed
+      }
+      done[batch[end].index] = true;
+      W weight = edge->second;
+      totalWeight -= weight;
+      --edgeCount;
+      connected.erase(edge);
+      edgesChanged(from);
+      --vertices[to]->inDegree;
+      if (!directional) {
+        eraseEdge(vertices[to]->connected, from);
+        edgesChanged(to);
+        moveDegree(vertices[to]->connected.size() + 1, -1);
+        --vertices[from]->inDegree;
       }
+      notifyRemoved(from, to, weight);
     }
+    if (static_cast<int>(connected.size()) != oldDegree) {
+      moveDegree(oldDegree, connected.size() - oldDegree);
+    }
+    begin = end;
   }
+  return done;
+}
+
+// write the graph in the binary format read by FrozenGraph::readBinary
+template <> bool Graph::writeBinary(const string &filename) const {
+  return freeze().writeBinary(filename);
+}
+
+// @return an immutable snapshot of the graph in CSR form
+template <> FrozenGraph Graph::freeze() const { return FrozenGraph(*this); }
+
+// depth-first traversal starting from given startLabel
+template <typename W>
+void BasicGraph<W>::dfs(const string &startLabel,
+                        void visit(const string &label)) {
+  GRAPH_QUERY("dfs");
+  dfs(id(startLabel), visit);
+}
+
+// depth-first traversal starting from the vertex with the given id
+// uses an explicit stack, so deep graphs cannot overflow the call stack
+template <typename W>
+void BasicGraph<W>::dfs(VertexId start, void visit(const string &label)) {
+  dfs(start, [this, visit](VertexId v) { visit(label(v)); });
+}
+
+// depth-first search from startLabel without visiting anything
+template <typename W>
+DfsResult BasicGraph<W>::dfsTree(const string &startLabel) const {
+  GRAPH_QUERY("dfsTree");
+  GRAPH_PHASE(Phase::Search);
+  VertexId start = id(startLabel);
+  if (start == -1) {
+    return DfsResult(verticesSize());
+  }
+  return dfsSearch(IdView{*this}, vector<int>(1, start), [](VertexId) {});
+}
+
+// depth-first search forest over the whole graph, roots in id order
+template <typename W>
+DfsResult BasicGraph<W>::dfsForest() const {
+  GRAPH_QUERY("dfsForest");
+  GRAPH_PHASE(Phase::Search);
+  vector<int> roots(verticesSize());
+  for (VertexId i = 0; i < verticesSize(); ++i) {
+    roots[i] = i;
+  }
+  return dfsSearch(IdView{*this}, roots, [](VertexId) {});
+}
+
+// strongly connected components, ids in a topological order of the
+// condensation
+template <typename W>
+SccResult BasicGraph<W>::stronglyConnectedComponents(int threads) const {
+  GRAPH_QUERY("stronglyConnectedComponents");
+  GRAPH_PHASE(Phase::Search);
+  if (threads == 1) {
+    return tarjanScc(IdView{*this});
+  }
+  vector<int> offsets;
+  vector<int> targets;
+  viewToCsr(IdView{*this}, offsets, targets);
+  CsrArrays out{verticesSize(), offsets.data(), targets.data()};
+  if (!directional) {
+    return parallelScc(out, out, threads);
+  }
+  vector<int> inOffsets;
+  vector<int> sources;
+  CsrArrays in = transposeCsr(out, inOffsets, sources);
+  return parallelScc(out, in, threads);
+}
+
+// breadth-first traversal starting from startLabel
+template <typename W>
+void BasicGraph<W>::bfs(const string &startLabel,
+                        void visit(const string &label)) {
+  GRAPH_QUERY("bfs");
+  bfs(id(startLabel), visit);
+}
+
+// breadth-first traversal starting from the vertex with the given id
+template <typename W>
+void BasicGraph<W>::bfs(VertexId start, void visit(const string &label)) {
+  bfs(start, [this, visit](VertexId v) { visit(label(v)); });
 }
 
 // find the total weight to every Vertex on the
 // connected graph from the start Label
-pair<map<string, int>, map<string, string>>
-Graph::dijkstra(const string &startLabel) const {
-  map<string, int> weights;
+template <typename W>
+pair<map<string, PathLength<W>>, map<string, string>>
+BasicGraph<W>::dijkstra(const string &startLabel,
+                        const DijkstraOptions &options) const {
+  GRAPH_QUERY("dijkstra");
+  map<string, Length> weights;
   map<string, string> previous;
-  if (vertices.count(startLabel) == 0) {
+  VertexId start = id(startLabel);
+  if (start == -1) {
     return make_pair(weights, previous);
   }
-  set<string> visited;
-  queue<Edge> edges;
-  visited.insert(startLabel);
-  for (auto const &j : vertices.at(startLabel)->connected) {
-    edges.push({vertices.at(startLabel), j.second, j.first});
-  }
-  int prevWeight;
-  int toWeight;
-  while (!edges.empty()) {
-    Edge edge = edges.front();
-    edges.pop();
-    prevWeight =
-        weights.count(edge.to->val) == 1 ? weights[edge.to->val] : INT_MAX;
-    toWeight = weights.count(edge.from->val) == 1
-                   ? edge.weight + weights[edge.from->val]
-                   : edge.weight;
-    if (prevWeight > toWeight) {
-      weights[edge.to->val] = toWeight;
-      previous[edge.to->val] = edge.from->val;
-    }
-    if (visited.count(edge.to->val) == 0) {
-      visited.insert(edge.to->val);
-      for (auto const &i : edge.to->connected) {
-        if (i.first->val != startLabel) {
-          edges.push({edge.to, i.second, i.first});
-        }
-      }
+  pair<vector<Length>, vector<VertexId>> result = dijkstra(start, options);
+  GRAPH_PHASE(Phase::Output);
+  for (VertexId i = 0; i < verticesSize(); ++i) {
+    if (result.second[i] != -1) {
+      weights[label(i)] = result.first[i];
+      previous[label(i)] = label(result.second[i]);
     }
   }
   return make_pair(weights, previous);
 }
 
-// minimum spanning tree using Prim's algorithm
-int Graph::mstPrim(const string &startLabel,
-                   void visit(const string &from, const string &to,
-                              int weight)) const {
-  if (directional || vertices.empty() || vertices.count(startLabel) == 0) {
-    return -1;
-  }
-  set<Vertex *> visited;
-  // making comparator
-  auto compare = [](Edge a, Edge b) { return a.weight > b.weight; };
-  // declaring prio queue
-  priority_queue<Edge, vector<Edge>, decltype(compare)> edges(compare);
-  // finding + adding all edges from starting vertex
-  visited.insert(vertices.at(startLabel));
-  for (auto const &i : vertices.at(startLabel)->connected) {
-    edges.push({vertices.at(startLabel), i.second, i.first});
-  }
-  int weight = 0;
-  while (!edges.empty()) {
-    // choose lowest weight edge and "add" to the mst
-    Edge curr = edges.top();
-    edges.pop();
-    if (visited.count(curr.to) == 0) {
-      weight += curr.weight;
-      visited.insert(curr.to);
-      visit(curr.from->val, curr.to->val, curr.weight);
-      // finding + adding all edges from end node of lowest
-      // weight edge chosen previously
-      for (auto const &i : curr.to->connected) {
-        if (visited.count(i.first) == 0) {
-          edges.push({curr.to, i.second, i.first});
-        }
-      }
-    }
+// dijkstra's algorithm over vertex ids
+template <typename W>
+pair<vector<PathLength<W>>, vector<VertexId>>
+BasicGraph<W>::dijkstra(VertexId start, const DijkstraOptions &options) const {
+  GRAPH_QUERY("dijkstra");
+  GRAPH_PHASE(Phase::Search);
+  vector<Length> dist;
+  vector<VertexId> prev;
+  if (vertexDegree(start) != -1) {
+    dijkstraSearch(IdView{*this}, start, -1, options, dist, prev);
   }
-  return weight;
+  return make_pair(dist, prev);
 }
 
-// minimum spanning tree using Kruskal's algorithm
-int Graph::mstKruskal(const string &startLabel,
-                      void visit(const string &from, const string &to,
-                                 int weight)) const {
-  // edge case check
-  if (directional || vertices.empty() || vertices.count(startLabel) == 0) {
-    return -1;
-  }
-  // prio queue for edges sorted by lowest weight
-  auto compare = [](Edge a, Edge b) { return a.weight > b.weight; };
-  priority_queue<Edge, vector<Edge>, decltype(compare)> edges(compare);
-  // strcutures used to formulate all edges of the graph
-  set<Vertex *> visited;
-  queue<Vertex *> q;
-  Vertex *curr;
-  visited.insert(vertices.at(startLabel));
-  q.push(vertices.at(startLabel));
-  map<Vertex *, set<Vertex *>> origin;
-  // use bfs to add all edges to the prio queue
-  while (!q.empty()) {
-    curr = q.front();
-    q.pop();
-    for (auto const &i : curr->connected) {
-      if (visited.count(i.first) == 0) {
-        q.push(i.first);
-        visited.insert(i.first);
-      }
-      if (origin[curr].count(i.first) == 0) {
-        origin[i.first].insert(curr);
-        edges.push({curr, i.second, i.first});
-      }
-    }
+// shortest path between two vertices, stops once "to" is settled
+template <typename W>
+pair<PathLength<W>, vector<string>>
+BasicGraph<W>::shortestPath(const string &from, const string &to,
+                            const DijkstraOptions &options) const {
+  GRAPH_QUERY("shortestPath");
+  vector<string> path;
+  pair<Length, vector<VertexId>> found =
+      shortestPath(id(from), id(to), options);
+  GRAPH_PHASE(Phase::Output);
+  for (VertexId v : found.second) {
+    path.push_back(label(v));
   }
-  // go through the prio queue, adding if not a cycle
-  // ending when the prio queue is empty
-  origin.clear();
-  Edge edge;
-  int weight = 0;
-  while (!edges.empty()) {
-    edge = edges.top();
-    edges.pop();
-    if (!cycle(origin, edge)) {
-      origin[edge.from].insert(edge.to);
-      origin[edge.to].insert(edge.from);
-      visit(edge.from->val, edge.to->val, edge.weight);
-      weight += edge.weight;
-    }
+  return make_pair(found.first, path);
+}
+
+// shortest path between two vertices given by id
+template <typename W>
+pair<PathLength<W>, vector<VertexId>>
+BasicGraph<W>::shortestPath(VertexId from, VertexId to,
+                            const DijkstraOptions &options) const {
+  GRAPH_QUERY("shortestPath");
+  vector<VertexId> path;
+  if (vertexDegree(from) == -1 || vertexDegree(to) == -1) {
+    return make_pair(Length(-1), path);
   }
-  return weight;
+  vector<Length> dist;
+  vector<VertexId> prev;
+  {
+    GRAPH_PHASE(Phase::Search);
+    dijkstraSearch(IdView{*this}, from, to, options, dist, prev);
+  }
+  if (dist[to] == numeric_limits<Length>::max()) {
+    return make_pair(Length(-1), path);
+  }
+  for (VertexId v = to; v != -1; v = prev[v]) {
+    path.push_back(v);
+  }
+  reverse(path.begin(), path.end());
+  return make_pair(dist[to], path);
 }
 
-// checks to see if the two vertexs on an edge have a cycle to each other
-bool Graph::cycle(const map<Vertex *, set<Vertex *>> &origin, Edge edge) const {
-  // using dfs to see if any vertex on the path from edge.from
-  // on the current mst is connected to edge.to, if so return
-  // true
-  stack<Vertex *> s;
-  set<Vertex *> cycVisited;
-  cycVisited.insert(edge.from);
-  if (origin.count(edge.from) == 1) {
-    for (auto const &i : edge.from->connected) {
-      if (origin.at(edge.from).count(i.first) == 1) {
-        s.push(i.first);
-      }
+// shortest path cost from every source to every target
+template <typename W>
+DistanceMatrix<PathLength<W>>
+BasicGraph<W>::distanceMatrix(const vector<string> &sources,
+                              const vector<string> &targets,
+                              int threads) const {
+  GRAPH_QUERY("distanceMatrix");
+  vector<VertexId> sourceIds;
+  vector<VertexId> targetIds;
+  {
+    GRAPH_PHASE(Phase::Setup);
+    for (auto const &source : sources) {
+      sourceIds.push_back(id(source));
     }
-  }
-  while (!s.empty()) {
-    Vertex *curr = s.top();
-    s.pop();
-    if (origin.at(curr).count(edge.to) == 1) {
-      return true;
+    for (auto const &target : targets) {
+      targetIds.push_back(id(target));
     }
-    for (auto const &i : curr->connected) {
-      if (origin.at(curr).count(i.first) == 1 &&
-          cycVisited.count(i.first) == 0) {
-        s.push(i.first);
-        cycVisited.insert(i.first);
-      }
+  }
+  DistanceMatrix<Length> matrix;
+  {
+    GRAPH_PHASE(Phase::Search);
+    matrix = distanceSearch(IdView{*this}, sourceIds, targetIds, threads);
+  }
+  GRAPH_PHASE(Phase::Output);
+  for (Length &distance : matrix.distances) {
+    if (distance == numeric_limits<Length>::max()) {
+      distance = -1;
     }
   }
-  return false;
+  return matrix;
+}
+
+// minimum spanning tree using Prim's algorithm
+template <typename W>
+PathLength<W>
+BasicGraph<W>::mstPrim(const string &startLabel,
+                       void visit(const string &from, const string &to,
+                                  W weight)) const {
+  return mstPrim(id(startLabel),
+                 [this, visit](VertexId from, VertexId to, W weight) {
+                   visit(label(from), label(to), weight);
+                 });
+}
+
+// minimum spanning tree using Kruskal's algorithm
+// union-find rejects the edges that would close a cycle
+template <typename W>
+PathLength<W>
+BasicGraph<W>::mstKruskal(const string &startLabel,
+                          void visit(const string &from, const string &to,
+                                     W weight)) const {
+  return mstKruskal(id(startLabel),
+                    [this, visit](VertexId from, VertexId to, W weight) {
+                      visit(label(from), label(to), weight);
+                    });
 }
 
 // read a text file and create the graph
-bool Graph::readFile(const string &filename) {
+template <typename W>
+bool BasicGraph<W>::readFile(const string &filename) {
+  GRAPH_QUERY("readFile");
   ifstream myfile(filename);
   if (!myfile.is_open()) {
     cerr << "Failed to open " << filename << endl;
     return false;
   }
   int edges = 0;
-  int weight = 0;
+  W weight = 0;
   string fromVertex;
   string toVertex;
   myfile >> edges;
+  // added as one batch, so every vertex gets its edges in one allocation
+  vector<BasicEdgeUpdate<W>> batch;
   for (int i = 0; i < edges; ++i) {
     myfile >> fromVertex >> toVertex >> weight;
-    connect(fromVertex, toVertex, weight);
+    batch.push_back({fromVertex, toVertex, weight});
   }
   myfile.close();
+  connectBatch(batch);
   return true;
 }
+
+namespace {
+// edges parsed from one chunk of a file, labels are local to the chunk
+template <typename W> struct ParsedChunk {
+  vector<string> labels;
+  vector<int> from;
+  vector<int> to;
+  vector<W> weight;
+};
+
+// @return the weight at pos, end is set after it as strtol does
+template <typename W> W parseWeight(const char *pos, char **end) {
+  if (is_floating_point<W>::value) {
+    return static_cast<W>(strtod(pos, end));
+  }
+  return static_cast<W>(strtoll(pos, end, 10));
+}
+
+// @return pointer to the first character after the line starting at pos
+const char *nextLine(const char *pos, const char *end) {
+  const char *newline =
+      static_cast<const char *>(memchr(pos, '\n', end - pos));
+  return newline == nullptr ? end : newline + 1;
+}
+
+// @return true if the line has nothing but whitespace
+bool blankLine(const char *pos, const char *end) {
+  for (; pos < end; ++pos) {
+    if (isspace(static_cast<unsigned char>(*pos)) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// tokenize "from to weight" lines in [begin, end), interning labels
+// into chunk-local ids in order of first appearance
+template <typename W>
+void parseChunk(const char *begin, const char *end, ParsedChunk<W> &chunk) {
+  unordered_map<string, int> local;
+  string token[2];
+  for (const char *line = begin; line < end;) {
+    const char *lineEnd = nextLine(line, end);
+    const char *pos = line;
+    int found = 0;
+    for (; found < 2; ++found) {
+      while (pos < lineEnd && isspace(static_cast<unsigned char>(*pos))) {
+        ++pos;
+      }
+      const char *start = pos;
+      while (pos < lineEnd && !isspace(static_cast<unsigned char>(*pos))) {
+        ++pos;
+      }
+      if (start == pos) {
+        break;
+      }
+      token[found].assign(start, pos);
+    }
+    char *weightEnd = nullptr;
+    W weight = found == 2 ? parseWeight<W>(pos, &weightEnd) : 0;
+    line = lineEnd;
+    if (found < 2 || weightEnd == pos || weightEnd > lineEnd) {
+      continue; // malformed line
+    }
+    for (int i = 0; i < 2; ++i) {
+      auto inserted = local.insert(make_pair(token[i], local.size()));
+      if (inserted.second) {
+        chunk.labels.push_back(token[i]);
+      }
+      (i == 0 ? chunk.from : chunk.to).push_back(inserted.first->second);
+    }
+    chunk.weight.push_back(weight);
+  }
+}
+} // namespace
+
+// read a text file using several threads to tokenize the edge lines
+template <typename W>
+bool BasicGraph<W>::readFileParallel(const string &filename, int threads) {
+  GRAPH_QUERY("readFileParallel");
+  ifstream myfile(filename, ios::binary);
+  if (!myfile.is_open()) {
+    cerr << "Failed to open " << filename << endl;
+    return false;
+  }
+  string text((istreambuf_iterator<char>(myfile)),
+              istreambuf_iterator<char>());
+  myfile.close();
+  const char *pos = text.c_str();
+  const char *end = pos + text.size();
+  char *countEnd = nullptr;
+  long edges = strtol(pos, &countEnd, 10);
+  // the edge lines are the first non-blank lines after the count line,
+  // the free-form text after them is never looked at
+  const char *begin = nextLine(countEnd, end);
+  const char *last = begin;
+  for (long found = 0; found < edges && last < end;) {
+    const char *lineEnd = nextLine(last, end);
+    if (!blankLine(last, lineEnd)) {
+      ++found;
+    }
+    last = lineEnd;
+  }
+  threads = threadCount(threads);
+  // split at line boundaries into roughly equal byte ranges
+  vector<const char *> bounds(1, begin);
+  for (int i = 1; i < threads; ++i) {
+    const char *split = begin + (last - begin) * i / threads;
+    split = split <= bounds.back() ? bounds.back() : nextLine(split - 1, last);
+    bounds.push_back(split);
+  }
+  bounds.push_back(last);
+  vector<ParsedChunk<W>> chunks(threads);
+  vector<thread> workers;
+  for (int i = 1; i < threads; ++i) {
+    workers.emplace_back(parseChunk<W>, bounds[i], bounds[i + 1],
+                         ref(chunks[i]));
+  }
+  parseChunk(bounds[0], bounds[1], chunks[0]);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  // merge in file order so ids, duplicates and weights match readFile
+  // vertices are created lazily so a self-loop does not add its vertex
+  vector<vector<VertexId>> resolved(threads);
+  vector<VertexId> ends;
+  for (int c = 0; c < threads; ++c) {
+    const ParsedChunk<W> &chunk = chunks[c];
+    resolved[c].assign(chunk.labels.size(), -1);
+    for (size_t i = 0; i < chunk.from.size(); ++i) {
+      int from = chunk.from[i];
+      int to = chunk.to[i];
+      if (from == to) {
+        continue;
+      }
+      if (resolved[c][from] == -1) {
+        resolved[c][from] = findOrAdd(chunk.labels[from]);
+      }
+      if (resolved[c][to] == -1) {
+        resolved[c][to] = findOrAdd(chunk.labels[to]);
+      }
+      ends.push_back(resolved[c][from]);
+      if (!directional) {
+        ends.push_back(resolved[c][to]);
+      }
+    }
+  }
+  reserveEdges(ends);
+  for (int c = 0; c < threads; ++c) {
+    const ParsedChunk<W> &chunk = chunks[c];
+    for (size_t i = 0; i < chunk.from.size(); ++i) {
+      if (chunk.from[i] != chunk.to[i]) {
+        connect(resolved[c][chunk.from[i]], resolved[c][chunk.to[i]],
+                chunk.weight[i]);
+      }
+    }
+  }
+  return true;
+}
+
+// minimum spanning forest using a parallel Boruvka
+template <typename W>
+vector<PathLength<W>>
+BasicGraph<W>::mstParallel(void visit(const string &from, const string &to,
+                                      W weight),
+                           int threads) const {
+  GRAPH_QUERY("mstParallel");
+  vector<Length> totals;
+  if (directional) {
+    return totals;
+  }
+  vector<MstEdge<W>> forest;
+  {
+    GRAPH_PHASE(Phase::Search);
+    totals = boruvkaForest(IdView{*this}, threads, forest);
+  }
+  GRAPH_PHASE(Phase::Output);
+  for (auto const &edge : forest) {
+    visit(label(edge.from), label(edge.to), edge.weight);
+  }
+  return totals;
+}
+
+// 16-bit weights must pack with their id, or they save no memory
+static_assert(sizeof(AdjacentEdge<uint16_t>) == 6, "packed 16-bit edge");
+static_assert(sizeof(AdjacentEdge<int>) == 8, "int edge is a pair");
+
+template class BasicGraph<int>;
+template class BasicGraph<uint16_t>;
+template class BasicGraph<int64_t>;
+template class BasicGraph<double>;
@@ -3,58 +3,243 @@
  * Vertex labels are unique.
  * A vertex can be connected to other vertices via weighted, directed edge.
  * A vertex cannot connect to itself or have multiple edges to the same vertex
+ *
+ * Labels are interned: every vertex also has a dense integer VertexId,
+ * handed out in order of creation. Most methods come in two forms, one
+ * taking labels and one taking ids; the id forms skip the label lookup
+ * and are meant for hot loops.
+ *
+ * BasicGraph<W> keeps edge weights of type W, and Graph is
+ * BasicGraph<int>. The instances built in graph.cpp are int, uint16_t
+ * (6 bytes an edge instead of 8), int64_t (long paths) and double (real
+ * costs). Path
+ * lengths and tree totals are PathLength<W>, see weight.h; the classes
+ * built on top of a Graph (FrozenGraph, DynamicMst and the rest) take
+ * int weights only.
  */
 
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include "arena.h"
+#include "dfs.h"
+#include "instrument.h"
+#include "labeltable.h"
+#include "mst.h"
+#include "scc.h"
+#include "shortestpath.h"
+#include "visitor.h"
+#include "weight.h"
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
 #include <set>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 using namespace std;
 
-class Graph {
+class FrozenGraph;
+
+// one edge in an adjacency array, the other end and the weight, read as
+// first and second like the pair it stands in for
+// packed to 2-byte alignment, a pair<VertexId, uint16_t> is padded to 8
+// bytes and this is 6
+#pragma pack(push, 2)
+template <typename W> struct PackedEdge {
+  VertexId first;
+  W second;
+  PackedEdge() = default;
+  PackedEdge(VertexId first, W second) : first(first), second(second) {}
+};
+#pragma pack(pop)
+
+// entry of the adjacency arrays for weights of type W, packed when W is
+// narrower than a vertex id, a plain pair otherwise
+template <typename W>
+using AdjacentEdge =
+    typename conditional<(sizeof(W) < sizeof(VertexId)), PackedEdge<W>,
+                         pair<VertexId, W>>::type;
+
+// where a Graph gets the memory for its vertices and edges
+// Arena: carved from large slabs and released all at once with the graph
+// Heap: one operator new per vertex and edge, freed one at a time
+enum class AllocationPolicy { Arena, Heap };
+
+// counters kept up to date by connect and disconnect, so taking a
+// snapshot never walks the adjacency
+// an undirected edge counts once in edges and totalWeight
+template <typename W> struct BasicGraphStats {
+  int vertices;
+  int edges;
+  WeightTotal<W> totalWeight;
+  int maxDegree;
+  // degreeHistogram[d] is the number of vertices with out-degree d,
+  // the last entry is for maxDegree
+  vector<int> degreeHistogram;
+};
+
+using GraphStats = BasicGraphStats<int>;
+
+// one edge of a connectBatch or disconnectBatch call
+// weight is ignored by disconnectBatch
+template <typename W> struct BasicEdgeUpdate {
+  string from;
+  string to;
+  W weight;
+};
+
+using EdgeUpdate = BasicEdgeUpdate<int>;
+
+// told about every edge added to or removed from a Graph it observes,
+// see Graph::addObserver
+// an undirected edge is reported once, in either direction
+template <typename W> class BasicGraphObserver {
+public:
+  virtual ~BasicGraphObserver() = default;
+
+  // called right after the edge from -> to was added
+  virtual void edgeAdded(VertexId from, VertexId to, W weight) = 0;
+
+  // called right after the edge from -> to was removed
+  virtual void edgeRemoved(VertexId from, VertexId to, W weight) = 0;
+};
+
+using GraphObserver = BasicGraphObserver<int>;
+
+template <typename W> class BasicGraph {
+public:
+  // type of an edge weight
+  typedef W Weight;
+  // type of path lengths and tree totals, see weight.h
+  typedef PathLength<W> Length;
+
 private:
   bool directional;
+  // edges of one vertex as (other end, weight) pairs in one flat array
+  // ordered by the id of the other end, found by binary search
+  // each element is 8 bytes for int weights and 6 for uint16_t, memory
+  // from the graph's arena. connectBatch, readFile and readFileParallel
+  // size each array once, about one element per stored edge end. Edges
+  // added one connect at a time grow the arrays by half, and the arena
+  // keeps the blocks they outgrow for reuse, which costs about twice that
+  using Adjacency =
+      vector<AdjacentEdge<W>, ArenaAllocator<AdjacentEdge<W>>>;
+  // edges of one vertex in label order, memory from the graph's arena
+  using SortedAdjacency = Adjacency;
   struct Vertex {
-    string val;
-    map<struct Vertex*, int> connected;
+    Adjacency connected;
+    int inDegree;
+    // connected in label order, rebuilt on first use after a change
+    mutable SortedAdjacency sorted;
+    mutable atomic<bool> sortedValid;
+
+    explicit Vertex(Arena *arena)
+        : connected(ArenaAllocator<AdjacentEdge<W>>(arena)),
+          inDegree(0), sorted(ArenaAllocator<AdjacentEdge<W>>(arena)),
+          sortedValid(false) {}
   };
   
   using Vertex = struct Vertex;
   struct Edge {
-    Vertex* from;
-    int weight;
-    Vertex* to;
+    VertexId from;
+    W weight;
+    VertexId to;
   };
   using Edge = struct Edge;
-  map<string, Vertex*> vertices;
+  // memory for vertices and edges, null for AllocationPolicy::Heap
+  unique_ptr<Arena> arena;
+  // labels and ids of all vertices
+  LabelTable labels;
+  // vertices by id, vertices are never removed so ids stay dense
+  vector<Vertex*> vertices;
+  // running totals behind edgesSize and stats
+  int edgeCount;
+  WeightTotal<W> totalWeight;
+  vector<int> degreeHistogram;
+  // held while a sorted adjacency is rebuilt, so that const traversals
+  // can still run on several threads at once
+  mutable mutex sortedLock;
+  // told about every change, see addObserver
+  vector<BasicGraphObserver<W> *> observers;
+
+  // @return id of the vertex with the given label, created if necessary
+  VertexId findOrAdd(const string &label);
+
+  // @return position of the edge to to in connected, or of the first
+  // edge to a larger id if there is none
+  static typename Adjacency::iterator findEdge(Adjacency &connected,
+                                              VertexId to);
+
+  // make room in connected for count more edges
+  static void reserveEdge(Adjacency &connected, size_t count = 1);
+
+  // make room for the edges about to be added in one allocation per
+  // vertex, ends holds the vertex of every edge end and is sorted
+  void reserveEdges(vector<VertexId> &ends);
+
+  // add an edge to to with weight to connected, keeping it ordered
+  // @return false if connected already has an edge to to
+  static bool insertEdge(Adjacency &connected, VertexId to, W weight);
+
+  // remove the edge to to from connected
+  // @return its weight, connected must have it
+  static W eraseEdge(Adjacency &connected, VertexId to);
+
+  // @return the edges of a vertex sorted by the label of the other end
+  // sorted once and kept until the edges of the vertex change
+  const SortedAdjacency &sortedEdges(VertexId id) const;
+
+  // drop the sorted edges of a vertex after its edges changed
+  void edgesChanged(VertexId id);
 
-  // recursive method for DFS traversal
-  void dfsTraverse(set<Vertex*>& visited, Vertex* curr, void visit(const string &label));
+  // tell the observers the edge from -> to was added
+  void notifyAdded(VertexId from, VertexId to, W weight);
 
-  //checks to see if the two vertexs on an edge have a cycle to each other
-  bool cycle(const map<Vertex *, set<Vertex *>> &origin, Edge edge) const;
+  // tell the observers the edge from -> to was removed
+  void notifyRemoved(VertexId from, VertexId to, W weight);
+
+  // integer id view of the adjacency used by the search engines
+  struct IdView {
+    typedef W Weight;
+    const BasicGraph &graph;
+    int size() const { return graph.vertices.size(); }
+    template <typename F> void forEachEdge(int from, F f) const {
+      graph.forEachEdge(from, f);
+    }
+    template <typename F> void forEachSortedEdge(int from, F f) const {
+      for (auto const &i : graph.sortedEdges(from)) {
+        f(i.first, i.second);
+      }
+    }
+  };
+
+  // move one vertex between histogram buckets after its out-degree
+  // changed from oldDegree to oldDegree + delta
+  void moveDegree(int oldDegree, int delta);
 public:
   // constructor, empty graph
-  explicit Graph(bool directionalEdges = true);
+  explicit BasicGraph(bool directionalEdges = true,
+                      AllocationPolicy policy = AllocationPolicy::Arena);
 
   // copy not allowed
-  Graph(const Graph &other) = delete;
+  BasicGraph(const BasicGraph &other) = delete;
 
   // move not allowed
-  Graph(Graph &&other) = delete;
+  BasicGraph(BasicGraph &&other) = delete;
 
   // assignment not allowed
-  Graph &operator=(const Graph &other) = delete;
+  BasicGraph &operator=(const BasicGraph &other) = delete;
 
   // move assignment not allowed
-  Graph &operator=(Graph &&other) = delete;
+  BasicGraph &operator=(BasicGraph &&other) = delete;
 
   /** destructor, delete all vertices and edges */
-  ~Graph();
+  ~BasicGraph();
 
   // @return true if vertex added, false if it already is in the graph
   bool add(const string &label); //younes
@@ -62,67 +247,346 @@ public:
   // @return true if vertex is in the graph
   bool contains(const string &label) const;//younes
 
+  // @return id of the vertex with the given label, -1 if not found
+  VertexId id(const string &label) const;
+
+  // @return label of the vertex with the given id
+  const string &label(VertexId id) const;
+
   // @return total number of vertices
   int verticesSize() const; // younes
 
+  // @return true if edges are directed
+  bool isDirectional() const;
+
   // Add an edge between two vertices, create new vertices if necessary
   // A vertex cannot connect to itself, cannot have P->P
   // For digraphs (directed graphs), only one directed edge allowed, P->Q
   // Undirected graphs must have P->Q and Q->P with same weight
   // @return true if successfully connected
-  bool connect(const string &from, const string &to, int weight = 0); //Ali
+  bool connect(const string &from, const string &to, W weight = 0); //Ali
+
+  // Add an edge between two existing vertices, same rules as above
+  // @return true if successfully connected
+  bool connect(VertexId from, VertexId to, W weight = 0);
 
   // Remove edge from graph
   // @return true if edge successfully deleted
   bool disconnect(const string &from, const string &to); //Ali
 
-  // @return total number of edges
+  // Remove edge between two vertices given by id
+  // @return true if edge successfully deleted
+  bool disconnect(VertexId from, VertexId to);
+
+  // Add many edges at once, same rules as connect
+  // The edges are grouped by vertex so each vertex's adjacency is found
+  // once per group, and consecutive edges from the same label share one
+  // lookup. The outcome is the same as calling connect on each edge in
+  // order: the first of several edges between the same vertices wins
+  // @return for each edge, true if it was connected
+  vector<bool> connectBatch(const vector<BasicEdgeUpdate<W>> &edges);
+
+  // Remove many edges at once, same outcome as calling disconnect on each
+  // edge in order
+  // @return for each edge, true if it was deleted
+  vector<bool> disconnectBatch(const vector<BasicEdgeUpdate<W>> &edges);
+
+  // tell observer about every edge added or removed from now on, by
+  // connect, disconnect, the batch calls and readFile alike
+  // observers are told in the order they were added, right after each
+  // edge changed; the observer must be removed before it is destroyed
+  void addObserver(BasicGraphObserver<W> *observer);
+
+  // stop telling observer about changes
+  // @return true if it was observing
+  bool removeObserver(BasicGraphObserver<W> *observer);
+
+  // @return total number of edges, an undirected edge counts once
   int edgesSize() const; //Ali
 
+  // @return vertex, edge, weight and degree counters, O(max degree)
+  BasicGraphStats<W> stats() const;
+
   // @return number of edges from given vertex, -1 if vertex not found
   int vertexDegree(const string &label) const; // younes
 
+  // @return number of edges from given vertex, -1 if id not valid
+  int vertexDegree(VertexId id) const;
+
+  // @return number of edges into given vertex, -1 if vertex not found
+  // same as vertexDegree for undirected graphs
+  int inDegree(const string &label) const;
+
+  // @return number of edges into given vertex, -1 if id not valid
+  int inDegree(VertexId id) const;
+
+  // @return number of edges from given vertex, -1 if vertex not found
+  int outDegree(const string &label) const;
+
+  // @return number of edges from given vertex, -1 if id not valid
+  int outDegree(VertexId id) const;
+
   // @return string representing edges and weights, "" if vertex not found
   // A-3->B, A-5->C should return B(3),C(5)
   string getEdgesAsString(const string &label) const; //Ali
 
+  // @return string representing edges and weights, "" if id not valid
+  string getEdgesAsString(VertexId id) const;
+
+  // call f(VertexId to, W weight) for every edge leaving from,
+  // in no particular order
+  template <typename F> void forEachEdge(VertexId from, F f) const {
+    for (auto const &i : vertices[from]->connected) {
+      f(i.first, i.second);
+    }
+  }
+
   // Read edges from file
   // first line of file is an integer, indicating number of edges
-  // each line represents an edge in the form of "string string int"
+  // each line represents an edge in the form of "string string weight"
   // vertex labels cannot contain spaces
   // @return true if file successfully read
   bool readFile(const string &filename);
 
+  // Same as readFile, but the edge lines are split into chunks that are
+  // tokenized by separate threads, then added in file order
+  // Each edge must be on its own line, anything after the last edge line
+  // is ignored. threads = 0 uses one thread per hardware core
+  // @return true if file successfully read
+  bool readFileParallel(const string &filename, int threads = 0);
+
+  // Write the graph in the binary format read by FrozenGraph::readBinary
+  // int weights only, like FrozenGraph
+  // @return true if file successfully written
+  bool writeBinary(const string &filename) const;
+
+  // @return an immutable, cache-friendly snapshot of the graph
+  // later changes to this graph are not reflected in the snapshot
+  // int weights only, like FrozenGraph
+  FrozenGraph freeze() const;
+
   // depth-first traversal starting from given startLabel
   void dfs(const string &startLabel, void visit(const string &label));// Ali
 
+  // depth-first traversal starting from the vertex with the given id
+  void dfs(VertexId start, void visit(const string &label));
+
+  // depth-first traversal starting from the vertex with the given id,
+  // visit(VertexId) is called on each vertex, in the same order as dfs
+  // above, and may return false to stop the traversal (see visitor.h)
+  // Any callable works and is inlined, so lambdas can keep state
+  template <typename Visit> void dfs(VertexId start, Visit visit) const {
+    GRAPH_QUERY("dfs");
+    GRAPH_PHASE(Phase::Search);
+    if (vertexDegree(start) != -1) {
+      dfsSearch(IdView{*this}, vector<int>(1, start), visit);
+    }
+  }
+
+  // depth-first search from startLabel without visiting anything
+  // @return pre/post-order numbers, discovery/finish times and parents
+  // by vertex id, all -1 for vertices not reached
+  DfsResult dfsTree(const string &startLabel) const;
+
+  // depth-first search forest over the whole graph, a new search starts
+  // from each vertex not yet reached, in id order
+  // @return pre/post-order numbers, discovery/finish times and parents
+  DfsResult dfsForest() const;
+
+  // strongly connected components, ids in a topological order of the
+  // condensation, see scc.h
+  // threads == 1 runs Tarjan's algorithm, anything else the parallel
+  // forward-backward search on that many threads (0 = one per core)
+  // @return component of every vertex, by id, and the condensation DAG
+  SccResult stronglyConnectedComponents(int threads = 1) const;
+
   // breadth-first traversal starting from startLabel
   // call the function visit on each vertex label */
   void bfs(const string &startLabel, void visit(const string &label)); //Younes
 
+  // breadth-first traversal starting from the vertex with the given id
+  void bfs(VertexId start, void visit(const string &label));
+
+  // breadth-first traversal starting from the vertex with the given id,
+  // visit(VertexId) is called on each vertex, in the same order as bfs
+  // above, and may return false to stop the traversal (see visitor.h)
+  template <typename Visit> void bfs(VertexId start, Visit visit) const {
+    GRAPH_QUERY("bfs");
+    GRAPH_PHASE(Phase::Search);
+    if (vertexDegree(start) == -1) {
+      return;
+    }
+    vector<bool> visited(verticesSize(), false);
+    vector<VertexId> q(1, start);
+    visited[start] = true;
+    for (size_t head = 0; head < q.size(); ++head) {
+      VertexId curr = q[head];
+      GRAPH_COUNT(settled, 1);
+      if (!visitAndContinue(visit, curr)) {
+        return;
+      }
+      for (auto const &i : sortedEdges(curr)) {
+        GRAPH_COUNT(relaxed, 1);
+        if (!visited[i.first]) {
+          q.push_back(i.first);
+          visited[i.first] = true;
+        }
+      }
+    }
+  }
+
   // dijkstra's algorithm to find shortest distance to all other vertices
   // and the path to all other vertices
   // Path cost is recorded in the map passed in, e.g. weight["F"] = 10
   // How to get to the vertex is recorded previous["F"] = "C"
+  // Edge weights must not be negative, a path whose cost does not fit
+  // in Length is not taken (see weight.h)
   // @return a pair made up of two map objects, Weights and Previous
-  pair<map<string, int>, map<string, string>>
-  dijkstra(const string &startLabel) const;//younes
+  pair<map<string, Length>, map<string, string>>
+  dijkstra(const string &startLabel,
+           const DijkstraOptions &options = DijkstraOptions()) const;//younes
+
+  // dijkstra's algorithm over vertex ids
+  // @return a pair of vectors indexed by id, the path cost (the largest
+  // Length if not reachable) and the previous vertex on the path (-1 for
+  // the start vertex and for vertices that are not reachable)
+  pair<vector<Length>, vector<VertexId>>
+  dijkstra(VertexId start,
+           const DijkstraOptions &options = DijkstraOptions()) const;
+
+  // shortest path between two vertices, search stops once "to" is reached
+  // Edge weights must not be negative
+  // @return a pair of the path cost and the labels on the path from "from"
+  // to "to" inclusive, {-1, {}} if either vertex is missing or unreachable
+  pair<Length, vector<string>>
+  shortestPath(const string &from, const string &to,
+               const DijkstraOptions &options = DijkstraOptions()) const;
+
+  // shortest path between two vertices given by id
+  // @return a pair of the path cost and the ids on the path,
+  // {-1, {}} if either id is not valid or "to" is unreachable
+  pair<Length, vector<VertexId>>
+  shortestPath(VertexId from, VertexId to,
+               const DijkstraOptions &options = DijkstraOptions()) const;
+
+  // shortest path cost from every source to every target, the sources
+  // are shared out among threads (0 = one per core)
+  // Much faster than one dijkstra per source: no maps are built, each
+  // search stops once all targets are settled and repeated sources are
+  // searched once
+  // @return matrix with at(i, j) the cost from sources[i] to targets[j],
+  // -1 if either vertex is missing or targets[j] is unreachable
+  DistanceMatrix<Length> distanceMatrix(const vector<string> &sources,
+                                        const vector<string> &targets,
+                                        int threads = 0) const;
 
   // minimum spanning tree using Prim's algorithm
   // ONLY works for NONDIRECTED graphs
   // ASSUMES the edge [P->Q] has the same weight as [Q->P]
   // @return length of the minimum spanning tree or -1 if start vertex not
-  int mstPrim(const string &startLabel,
-              void visit(const string &from, const string &to,
-                         int weight)) const; //Ali
+  Length mstPrim(const string &startLabel,
+                 void visit(const string &from, const string &to,
+                            W weight)) const; //Ali
+
+  // minimum spanning tree using Prim's algorithm from the vertex with
+  // the given id, visit(VertexId from, VertexId to, W weight) is called
+  // on each tree edge, in the same order as mstPrim above, and may return
+  // false to stop growing the tree (see visitor.h)
+  // @return length of the tree grown, -1 if start is not valid or the
+  // graph is directed
+  template <typename Visit>
+  Length mstPrim(VertexId start, Visit visit) const {
+    GRAPH_QUERY("mstPrim");
+    GRAPH_PHASE(Phase::Search);
+    if (directional || vertexDegree(start) == -1) {
+      return -1;
+    }
+    vector<bool> visited(verticesSize(), false);
+    // making comparator
+    auto compare = [](Edge a, Edge b) { return a.weight > b.weight; };
+    // declaring prio queue
+    priority_queue<Edge, vector<Edge>, decltype(compare)> edges(compare);
+    // finding + adding all edges from starting vertex
+    visited[start] = true;
+    for (auto const &i : vertices[start]->connected) {
+      GRAPH_COUNT(heapPushes, 1);
+      edges.push({start, i.second, i.first});
+    }
+    Length weight = 0;
+    while (!edges.empty()) {
+      // choose lowest weight edge and "add" to the mst
+      Edge curr = edges.top();
+      edges.pop();
+      GRAPH_COUNT(heapPops, 1);
+      if (!visited[curr.to]) {
+        GRAPH_COUNT(settled, 1);
+        weight += curr.weight;
+        visited[curr.to] = true;
+        if (!visitAndContinue(visit, curr.from, curr.to, curr.weight)) {
+          break;
+        }
+        // finding + adding all edges from end node of lowest
+        // weight edge chosen previously
+        for (auto const &i : vertices[curr.to]->connected) {
+          GRAPH_COUNT(relaxed, 1);
+          if (!visited[i.first]) {
+            GRAPH_COUNT(heapPushes, 1);
+            edges.push({curr.to, i.second, i.first});
+          }
+        }
+      }
+    }
+    return weight;
+  }
 
   // minimum spanning tree using Kruskal's algorithm
   // ONLY works for NONDIRECTED graphs
   // ASSUMES the edge [P->Q] has the same weight as [Q->P]
   // @return length of the minimum spanning tree or -1 if start vertex not
-  int mstKruskal(const string &startLabel,
-                 void visit(const string &from, const string &to,
-                            int weight)) const; //Ali & Younes
+  Length mstKruskal(const string &startLabel,
+                    void visit(const string &from, const string &to,
+                               W weight)) const; //Ali & Younes
+
+  // minimum spanning tree using Kruskal's algorithm from the vertex with
+  // the given id, visit(VertexId from, VertexId to, W weight) is called
+  // on each tree edge, in the same order as mstKruskal above, and may
+  // return false to stop (see visitor.h)
+  // @return length of the edges visited, -1 if start is not valid or the
+  // graph is directed
+  template <typename Visit>
+  Length mstKruskal(VertexId start, Visit visit) const {
+    GRAPH_QUERY("mstKruskal");
+    if (directional || vertexDegree(start) == -1) {
+      return -1;
+    }
+    vector<MstEdge<W>> tree;
+    kruskalSearch(IdView{*this}, start, tree);
+    GRAPH_PHASE(Phase::Output);
+    Length weight = 0;
+    for (auto const &edge : tree) {
+      weight += edge.weight;
+      if (!visitAndContinue(visit, edge.from, edge.to, edge.weight)) {
+        break;
+      }
+    }
+    return weight;
+  }
+
+  // minimum spanning forest of the whole graph, every component included,
+  // using Boruvka's algorithm spread over threads (0 = one per core)
+  // ONLY works for NONDIRECTED graphs
+  // visit is called on the calling thread once all threads are done
+  // @return total weight of each component's tree, in order of the
+  // component's first vertex id, empty for directed graphs
+  vector<Length> mstParallel(void visit(const string &from,
+                                        const string &to, W weight),
+                             int threads = 0) const;
 };
 
+using Graph = BasicGraph<int>;
+
+// FrozenGraph keeps int weights, so only a Graph can be frozen
+template <> bool Graph::writeBinary(const string &filename) const;
+template <> FrozenGraph Graph::freeze() const;
+
 #endif // GRAPH_H
\ No newline at end of file
@@ -5,11 +5,24 @@
  * @date 19 Oct 2019
  */
 
+#include "concurrentgraph.h"
+#include "contractionhierarchy.h"
+#include "dynamicmst.h"
+#include "dynamicshortestpaths.h"
+#include "frozengraph.h"
 #include "graph.h"
+#include "instrument.h"
+#include "unionfind.h"
+#include <algorithm>
 #include <cassert>
+#include <climits>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string>
+#include <thread>
 
 using namespace std;
 
@@ -302,6 +315,1152 @@ void testGraph4Undirected() {
   assert(mstLength == 22 && "mst C is 22");
 }
 
+// tests that a frozen snapshot answers like the graph it came from
+void testFrozenGraph() {
+  cout << "testFrozenGraph" << endl;
+  Graph g;
+  if (!g.readFile("graph1.txt")) {
+    return;
+  }
+  FrozenGraph f = g.freeze();
+  g.connect("A", "X", 1);
+  assert(f.verticesSize() == 10 && f.edgesSize() == 9 && "snapshot sizes");
+  assert(!f.contains("xxx") && f.contains("A") && "snapshot contains");
+  assert(f.vertexDegree("A") == 2 && f.vertexDegree("xxx") == -1);
+  assert(f.getEdgesAsString("A") == "B(1),H(3)" && "snapshot unchanged");
+  assert(f.getEdgesAsString("G").empty() && "no outgoing edges G");
+
+  globalSS.str("");
+  f.dfs("A", vertexPrinter);
+  assert(globalSS.str() == "ABCDEFGH" && "frozen dfs starting from A");
+
+  globalSS.str("");
+  f.bfs("A", vertexPrinter);
+  assert(globalSS.str() == "ABHCGDEF" && "frozen bfs starting from A");
+
+  globalSS.str("");
+  f.bfs("xxx", vertexPrinter);
+  assert(globalSS.str().empty() && "frozen bfs from missing vertex");
+
+  map<string, int> weights;
+  map<string, string> previous;
+  tie(weights, previous) = f.dijkstra("A");
+  assert(map2string(weights) == "[B:1][C:2][D:3][E:4][F:5][G:4][H:3]" &&
+         "frozen Dijkstra(A) weights");
+  assert(map2string(previous) == "[B:A][C:B][D:C][E:D][F:E][G:H][H:A]" &&
+         "frozen Dijkstra(A) previous");
+  assert(f.mstPrim("A", edgePrinter) == -1 && "frozen mst on digraph");
+
+  Graph u(false);
+  if (!u.readFile("graph4.txt")) {
+    return;
+  }
+  FrozenGraph fu(u);
+  assert(fu.edgesSize() == 17 && "frozen undirected edge count");
+
+  globalSS.str("");
+  fu.dfs("A", vertexPrinter);
+  assert(globalSS.str() == "ABDKCLHIEGFJ" && "frozen dfs starting from A");
+
+  globalSS.str("");
+  fu.bfs("A", vertexPrinter);
+  assert(globalSS.str() == "ABEFHDGIJLKC" && "frozen bfs starting from A");
+
+  assert(fu.mstPrim("A", edgePrinter) == 22 && "frozen prim A is 22");
+  assert(fu.mstPrim("C", edgePrinter) == 22 && "frozen prim C is 22");
+  assert(fu.mstKruskal("A", edgePrinter) == 22 && "frozen kruskal A is 22");
+  assert(fu.mstKruskal("X", edgePrinter) == -1 && "frozen kruskal X");
+
+  // with equal weights only the length is the same as the graph's
+  Graph ties(false);
+  ties.connect("d", "c", 2);
+  ties.connect("c", "b", 2);
+  ties.connect("b", "a", 2);
+  ties.connect("a", "d", 2);
+  ties.connect("a", "c", 2);
+  assert(ties.freeze().mstPrim("c", edgePrinter) == 6 &&
+         ties.mstPrim("c", edgePrinter) == 6 && "frozen prim ties");
+}
+
+// tests point-to-point queries and every heap of the dijkstra engine
+void testShortestPath() {
+  cout << "testShortestPath" << endl;
+  Graph g;
+  if (!g.readFile("graph1.txt")) {
+    return;
+  }
+  pair<int, vector<string>> path = g.shortestPath("A", "G");
+  assert(path.first == 4 && "A to G costs 4");
+  assert(path.second == vector<string>({"A", "H", "G"}) && "A to G via H");
+  path = g.shortestPath("A", "A");
+  assert(path.first == 0 && path.second.size() == 1 && "A to A is free");
+  path = g.shortestPath("A", "Y");
+  assert(path.first == -1 && path.second.empty() && "Y unreachable");
+  path = g.shortestPath("A", "xxx");
+  assert(path.first == -1 && path.second.empty() && "xxx not in graph");
+  path = g.freeze().shortestPath("B", "F");
+  assert(path.first == 4 && path.second.size() == 5 && "frozen B to F");
+
+  Graph g4;
+  if (!g4.readFile("graph4.txt")) {
+    return;
+  }
+  FrozenGraph f4 = g4.freeze();
+  HeapKind heaps[] = {HeapKind::Binary, HeapKind::FourAry, HeapKind::Pairing};
+  for (HeapKind heap : heaps) {
+    DijkstraOptions options;
+    options.heap = heap;
+    auto p = g4.dijkstra("A", options);
+    assert(map2string(p.first) ==
+               "[B:6][D:15][E:2][F:2][G:3][H:8][I:3][J:5][K:4][L:11]" &&
+           "Dijkstra(A) weights with every heap");
+    p = f4.dijkstra("A", options);
+    assert(map2string(p.first) ==
+               "[B:6][D:15][E:2][F:2][G:3][H:8][I:3][J:5][K:4][L:11]" &&
+           "frozen Dijkstra(A) weights with every heap");
+    assert(g4.shortestPath("A", "K", options).first == 4 && "A to K is 4");
+    assert(g4.shortestPath("A", "D", options).second ==
+               vector<string>({"A", "B", "D"}) &&
+           "A to D via B");
+  }
+}
+
+// tests writing a graph in binary form and mapping it back
+void testBinaryFormat() {
+  cout << "testBinaryFormat" << endl;
+  Graph g(false);
+  if (!g.readFile("graph4.txt")) {
+    return;
+  }
+  string filename = "graph4-test.bin";
+  assert(g.writeBinary(filename) && "write binary graph");
+  FrozenGraph f;
+  assert(f.verticesSize() == 0 && !f.contains("A") && "empty snapshot");
+  assert(f.readBinary(filename) && "map binary graph");
+  assert(!f.isDirectional() && f.verticesSize() == 12 && f.edgesSize() == 17);
+  assert(f.getEdgesAsString("A") == g.getEdgesAsString("A"));
+
+  // moving keeps the mapping alive
+  FrozenGraph moved = move(f);
+  globalSS.str("");
+  moved.dfs("A", vertexPrinter);
+  assert(globalSS.str() == "ABDKCLHIEGFJ" && "mapped dfs starting from A");
+  assert(moved.mstKruskal("A", edgePrinter) == 22 && "mapped kruskal is 22");
+  assert(map2string(moved.dijkstra("C").first) ==
+             map2string(g.dijkstra("C").first) &&
+         "mapped Dijkstra(C) weights");
+
+  // damaged files of the right size are rejected: the header is 56 bytes
+  // with the byte order marker at 16, offsets[] follows 13 label offsets
+  ifstream in(filename, ios::binary);
+  string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+  in.close();
+  string damaged = bytes;
+  reverse(damaged.begin() + 16, damaged.begin() + 24);
+  ofstream(filename, ios::binary) << damaged;
+  assert(!moved.readBinary(filename) && "other byte order is rejected");
+  damaged = bytes;
+  damaged[56 + 13 * 4] = 1;
+  ofstream(filename, ios::binary) << damaged;
+  assert(!moved.readBinary(filename) && "offsets[0] must be 0");
+  damaged = bytes;
+  damaged[56 + 12 * 4] ^= 1;
+  ofstream(filename, ios::binary) << damaged;
+  assert(!moved.readBinary(filename) && "labelOffsets[n] is labelBytes");
+  // offsets[1] past offsets[2], then the first target past the last id
+  damaged = bytes;
+  damaged[56 + 14 * 4] = 100;
+  ofstream(filename, ios::binary) << damaged;
+  assert(!moved.readBinary(filename) && "offsets must not decrease");
+  damaged = bytes;
+  damaged[56 + 26 * 4] = 12;
+  ofstream(filename, ios::binary) << damaged;
+  assert(!moved.readBinary(filename) && "targets must be vertices");
+  ofstream(filename, ios::binary) << bytes;
+  assert(moved.readBinary(filename) && "undamaged copy still maps");
+  remove(filename.c_str());
+
+  assert(!moved.readBinary("graph4.txt") && "text file is rejected");
+  assert(moved.edgesSize() == 17 && "failed read keeps old graph");
+  assert(!moved.readBinary("xxx.bin") && "missing file");
+}
+
+// tests that the parallel loader builds the same graph as readFile
+void testReadFileParallel() {
+  cout << "testReadFileParallel" << endl;
+  int threadCounts[] = {1, 2, 3, 8};
+  for (int threads : threadCounts) {
+    Graph g;
+    assert(g.readFileParallel("graph1.txt", threads) && "parallel graph1");
+    assert(g.verticesSize() == 10 && g.edgesSize() == 9 && "comments ignored");
+    globalSS.str("");
+    g.dfs("A", vertexPrinter);
+    assert(globalSS.str() == "ABCDEFGH" && "parallel dfs starting from A");
+
+    Graph u(false);
+    assert(u.readFileParallel("graph4.txt", threads) && "parallel graph4");
+    assert(u.edgesSize() == 17 && "parallel undirected edge count");
+    globalSS.str("");
+    u.bfs("A", vertexPrinter);
+    assert(globalSS.str() == "ABEFHDGIJLKC" && "parallel bfs from A");
+    assert(u.mstKruskal("A", edgePrinter) == 22 && "parallel mst is 22");
+  }
+
+  // duplicates and self-loops follow the rules of connect
+  string filename = "parallel-test.txt";
+  ofstream out(filename);
+  out << "5\nA B 1\nB A 2\n\nA A 3\nA B 4\nC B 5\nD E 6\n";
+  out.close();
+  Graph d;
+  assert(d.readFileParallel(filename, 4) && "parallel duplicates");
+  assert(d.getEdgesAsString("A") == "B(1)" && "first duplicate wins");
+  assert(d.getEdgesAsString("B") == "A(2)" && "reverse edge kept");
+  assert(d.verticesSize() == 3 && !d.contains("D") && "count limits lines");
+  Graph u(false);
+  assert(u.readFileParallel(filename, 2) && "parallel undirected duplicates");
+  assert(u.getEdgesAsString("A") == "B(1)" && "undirected keeps first");
+  assert(u.edgesSize() == 2 && "undirected duplicates dropped");
+  remove(filename.c_str());
+
+  Graph missing;
+  assert(!missing.readFileParallel("xxx.txt") && "missing file");
+}
+
+// tests the integer vertex id forms of the graph methods
+void testVertexIds() {
+  cout << "testVertexIds" << endl;
+  Graph g;
+  assert(g.add("a") && g.add("b") && g.add("c") && "add vertices");
+  VertexId a = g.id("a");
+  VertexId b = g.id("b");
+  VertexId c = g.id("c");
+  assert(a == 0 && b == 1 && c == 2 && "ids in order of creation");
+  assert(g.id("xxx") == -1 && "no id for xxx");
+  assert(g.label(b) == "b" && "label of id");
+  assert(g.connect(a, c, 20) && g.connect(a, b, 10) && "connect by id");
+  assert(!g.connect(a, b, 5) && "duplicate connect by id");
+  assert(!g.connect(a, a, 1) && "connect id to itself");
+  assert(!g.connect(a, 7, 1) && !g.connect(-1, a, 1) && "invalid ids");
+  assert(g.vertexDegree(a) == 2 && g.vertexDegree(9) == -1);
+  assert(g.getEdgesAsString(a) == "b(10),c(20)" && "sorted by label");
+  assert(g.getEdgesAsString(-1).empty() && "no edges for invalid id");
+  int edges = 0;
+  int total = 0;
+  g.forEachEdge(a, [&](VertexId, int weight) {
+    ++edges;
+    total += weight;
+  });
+  assert(edges == 2 && total == 30 && "forEachEdge visits every edge");
+
+  g.connect("b", "c", 1);
+  pair<vector<int>, vector<VertexId>> result = g.dijkstra(a);
+  assert(result.first[c] == 11 && result.second[c] == b && "c through b");
+  assert(result.first[a] == 0 && result.second[a] == -1 && "start vertex");
+  assert(g.dijkstra(5).first.empty() && "dijkstra from invalid id");
+  pair<int, vector<VertexId>> path = g.shortestPath(a, c);
+  assert(path.first == 11 && path.second == vector<VertexId>({a, b, c}));
+  assert(g.shortestPath(c, a).first == -1 && "no path back to a");
+
+  globalSS.str("");
+  g.dfs(a, vertexPrinter);
+  assert(globalSS.str() == "abc" && "dfs by id");
+  globalSS.str("");
+  g.bfs(-1, vertexPrinter);
+  assert(globalSS.str().empty() && "bfs from invalid id");
+  assert(g.disconnect(a, b) && !g.disconnect(a, b) && "disconnect by id");
+  assert(!g.disconnect(a, 42) && "disconnect invalid id");
+}
+
+// tests the arena and that both allocation policies behave the same
+void testAllocationPolicy() {
+  cout << "testAllocationPolicy" << endl;
+  Arena arena(1024);
+  void *first = arena.allocate(40);
+  assert(arena.used() == 48 && arena.reserved() == 1024 && "one slab");
+  arena.deallocate(first, 40);
+  assert(arena.allocate(33) == first && "freed block is reused");
+  void *big = arena.allocate(4000);
+  assert(arena.used() == 4048 && "big block counted");
+  arena.deallocate(big, 4000);
+  assert(arena.reserved() == 1024 && "big block freed");
+  arena.allocate(2000);
+  arena.release();
+  assert(arena.used() == 0 && arena.reserved() == 0 && "all released");
+
+  AllocationPolicy policies[] = {AllocationPolicy::Arena,
+                                 AllocationPolicy::Heap};
+  for (AllocationPolicy policy : policies) {
+    Graph g(false, policy);
+    if (!g.readFile("graph4.txt")) {
+      return;
+    }
+    assert(g.disconnect("A", "B") && g.connect("B", "A", 6) && "reconnect");
+    assert(g.edgesSize() == 17 && "edge count after reconnect");
+    assert(g.getEdgesAsString("A") == "B(6),E(2),F(2),H(8)");
+    assert(g.mstKruskal("A", edgePrinter) == 22 && "mst A is 22");
+  }
+}
+
+// tests the union-find Kruskal and its visit order
+void testKruskal() {
+  cout << "testKruskal" << endl;
+  DisjointSets sets(4);
+  assert(sets.unite(0, 1) && sets.unite(2, 3) && !sets.unite(1, 0));
+  assert(sets.count() == 2 && sets.find(0) == sets.find(1));
+  assert(sets.unite(1, 3) && sets.find(0) == sets.find(2) && "one set");
+
+  Graph g(false);
+  if (!g.readFile("graph0.txt")) {
+    return;
+  }
+  globalSS.str("");
+  assert(g.mstKruskal("A", edgePrinter) == 4 && "kruskal A is 4");
+  assert(globalSS.str() == "[AB 1][CB 3]" && "kruskal A edges");
+  globalSS.str("");
+  assert(g.mstKruskal("C", edgePrinter) == 4 && "kruskal C is 4");
+  assert(globalSS.str() == "[AB 1][CB 3]" && "kruskal C edges");
+
+  // equal weights keep the order the edges were found in
+  Graph ties(false);
+  ties.connect("a", "b", 1);
+  ties.connect("b", "c", 1);
+  ties.connect("a", "c", 1);
+  ties.connect("x", "y", 1);
+  globalSS.str("");
+  assert(ties.mstKruskal("a", edgePrinter) == 2 && "only a's component");
+  assert(globalSS.str() == "[ab 1][ac 1]" && "ties in discovery order");
+  globalSS.str("");
+  ties.freeze().mstKruskal("a", edgePrinter);
+  assert(globalSS.str() == "[ab 1][ac 1]" && "frozen ties in same order");
+}
+
+// tests the parallel minimum spanning forest
+void testMstParallel() {
+  cout << "testMstParallel" << endl;
+  Graph g(false);
+  if (!g.readFile("graph4.txt")) {
+    return;
+  }
+  g.connect("X", "Y", 5);
+  g.connect("Y", "Z", 2);
+  g.connect("X", "Z", 1);
+  g.add("W");
+  string expected;
+  int threadCounts[] = {1, 2, 4, 0};
+  for (int threads : threadCounts) {
+    globalSS.str("");
+    vector<int> totals = g.mstParallel(edgePrinter, threads);
+    assert(totals == vector<int>({22, 3, 0}) && "one total per component");
+    if (expected.empty()) {
+      expected = globalSS.str();
+    }
+    assert(globalSS.str() == expected && "same edges for any thread count");
+  }
+  FrozenGraph f = g.freeze();
+  vector<int> totals = f.mstParallel(edgePrinter, 3);
+  assert(totals == vector<int>({22, 0, 3}) && "frozen totals by label");
+
+  Graph directed;
+  directed.connect("A", "B", 1);
+  assert(directed.mstParallel(edgePrinter).empty() && "directed has no mst");
+}
+
+// tests hop distances and parents from the direction-optimizing bfs
+void testBfsLevels() {
+  cout << "testBfsLevels" << endl;
+  Graph g;
+  if (!g.readFile("graph1.txt")) {
+    return;
+  }
+  FrozenGraph f = g.freeze();
+  int threadCounts[] = {1, 3};
+  for (int threads : threadCounts) {
+    BfsResult r = f.bfsLevels("A", threads);
+    assert(r.distance[f.id("A")] == 0 && r.parent[f.id("A")] == -1);
+    assert(r.distance[f.id("G")] == 2 && r.parent[f.id("G")] == f.id("H"));
+    assert(r.distance[f.id("F")] == 5 && r.parent[f.id("F")] == f.id("E"));
+    assert(r.distance[f.id("X")] == -1 && r.parent[f.id("X")] == -1);
+    r = f.bfsLevels("G", threads);
+    assert(r.distance[f.id("A")] == -1 && "directed edges only go forward");
+  }
+  assert(f.bfsLevels("xxx").distance.empty() && "missing start vertex");
+
+  // a hub reaching everything in one hop makes the search go bottom-up
+  Graph star(false);
+  for (int i = 0; i < 200; ++i) {
+    star.connect("hub", "s" + to_string(i), 1);
+    star.connect("s" + to_string(i), "t" + to_string(i), 1);
+  }
+  FrozenGraph fs = star.freeze();
+  BfsResult r = fs.bfsLevels("s7", 4);
+  assert(r.distance[fs.id("hub")] == 1 && r.distance[fs.id("s9")] == 2);
+  assert(r.distance[fs.id("t9")] == 3 && r.parent[fs.id("t9")] == fs.id("s9"));
+  assert(r.distance[fs.id("t7")] == 1 && "leaf of the start vertex");
+}
+
+// tests the iterative dfs numbering and a chain too deep for recursion
+void testDfsNumbering() {
+  cout << "testDfsNumbering" << endl;
+  Graph g;
+  if (!g.readFile("graph0.txt")) {
+    return;
+  }
+  VertexId a = g.id("A");
+  VertexId b = g.id("B");
+  VertexId c = g.id("C");
+  DfsResult r = g.dfsTree("A");
+  assert(r.preorder[a] == 0 && r.preorder[b] == 1 && r.preorder[c] == 2);
+  assert(r.postorder[c] == 0 && r.postorder[b] == 1 && r.postorder[a] == 2);
+  assert(r.discovery[c] == 2 && r.finish[c] == 3 && r.finish[a] == 5);
+  assert(r.parent[a] == -1 && r.parent[b] == a && r.parent[c] == b);
+  r = g.dfsTree("B");
+  assert(r.preorder[a] == -1 && r.finish[a] == -1 && "A not reachable");
+  assert(g.dfsTree("xxx").preorder[a] == -1 && "missing start vertex");
+
+  Graph g1;
+  if (!g1.readFile("graph1.txt")) {
+    return;
+  }
+  r = g1.dfsForest();
+  for (VertexId v = 0; v < g1.verticesSize(); ++v) {
+    assert(r.preorder[v] != -1 && r.finish[v] != -1 && "forest reaches all");
+  }
+  assert(r.preorder[g1.id("X")] >= 8 && r.preorder[g1.id("Y")] >= 8);
+  assert(r.parent[g1.id("H")] == g1.id("A") && r.parent[g1.id("A")] == -1);
+  // the snapshot numbers ids in label order, so A roots the first tree
+  FrozenGraph f1 = g1.freeze();
+  DfsResult fr = f1.dfsForest();
+  assert(fr.preorder[f1.id("X")] == 8 && fr.parent[f1.id("X")] == -1);
+  assert(fr.parent[f1.id("Y")] == f1.id("X") && fr.finish[f1.id("X")] == 19);
+
+  // recursion one frame per vertex would overflow on this chain
+  Graph chain;
+  int length = 100000;
+  for (int i = 0; i < length; ++i) {
+    chain.connect(to_string(i), to_string(i + 1), 1);
+  }
+  r = chain.dfsTree("0");
+  assert(r.preorder[chain.id(to_string(length))] == length && "deep chain");
+  assert(r.postorder[chain.id("0")] == length && "start finishes last");
+  globalSS.str("");
+  chain.freeze().dfs(to_string(length - 1), vertexPrinter);
+  assert(globalSS.str() == to_string(length - 1) + to_string(length));
+}
+
+// tests the counters kept by connect and disconnect
+void testGraphStats() {
+  cout << "testGraphStats" << endl;
+  Graph g;
+  g.add("a");
+  GraphStats st = g.stats();
+  assert(st.vertices == 1 && st.edges == 0 && st.totalWeight == 0);
+  assert(st.maxDegree == 0 && st.degreeHistogram == vector<int>({1}));
+  g.connect("a", "b", 5);
+  g.connect("a", "c", 7);
+  g.connect("b", "c", 1);
+  assert(!g.connect("a", "b", 9) && "duplicate does not count");
+  st = g.stats();
+  assert(st.vertices == 3 && st.edges == 3 && st.totalWeight == 13);
+  assert(st.maxDegree == 2 && st.degreeHistogram == vector<int>({1, 1, 1}));
+  assert(g.inDegree("c") == 2 && g.outDegree("c") == 0);
+  assert(g.inDegree("a") == 0 && g.outDegree("a") == 2);
+  assert(g.inDegree("xxx") == -1 && g.outDegree(-1) == -1);
+  assert(g.disconnect("a", "c") && !g.disconnect("a", "c"));
+  st = g.stats();
+  assert(st.edges == 2 && st.totalWeight == 6 && st.maxDegree == 1);
+  assert(st.degreeHistogram == vector<int>({1, 2}) && "top bucket dropped");
+  assert(g.inDegree("c") == 1 && g.edgesSize() == 2);
+
+  Graph u(false);
+  u.connect("a", "b", 4);
+  u.connect("b", "c", 6);
+  st = u.stats();
+  assert(st.edges == 2 && st.totalWeight == 10 && "undirected edge once");
+  assert(st.degreeHistogram == vector<int>({0, 2, 1}));
+  assert(u.inDegree("b") == 2 && u.outDegree("b") == 2);
+  u.disconnect("c", "b");
+  assert(u.edgesSize() == 1 && u.inDegree("b") == 1);
+  assert(u.stats().maxDegree == 1 && "max degree shrinks");
+
+  // the parallel reader goes through connect, so it keeps the counters
+  Graph p(false);
+  if (p.readFileParallel("graph2.txt", 3)) {
+    Graph q(false);
+    q.readFile("graph2.txt");
+    assert(p.edgesSize() == q.edgesSize() &&
+           p.stats().totalWeight == q.stats().totalWeight &&
+           p.stats().degreeHistogram == q.stats().degreeHistogram);
+  }
+}
+
+// tests that batches give the same graph as one call per edge
+void testBatch() {
+  cout << "testBatch" << endl;
+  vector<EdgeUpdate> edges = {{"c", "a", 3}, {"a", "b", 1}, {"a", "a", 9},
+                              {"b", "a", 2}, {"a", "b", 7}, {"d", "c", 4},
+                              {"a", "c", 5}, {"c", "d", 6}};
+  for (bool directional : {true, false}) {
+    Graph batch(directional);
+    Graph single(directional);
+    vector<bool> done = batch.connectBatch(edges);
+    for (size_t i = 0; i < edges.size(); ++i) {
+      bool expected = single.connect(edges[i].from, edges[i].to,
+                                     edges[i].weight);
+      assert(done[i] == expected && "same status as connect");
+    }
+    assert(batch.verticesSize() == 4 && "self-loop adds no vertex");
+    for (VertexId v = 0; v < single.verticesSize(); ++v) {
+      assert(batch.label(v) == single.label(v) && "same ids");
+      assert(batch.getEdgesAsString(v) == single.getEdgesAsString(v));
+      assert(batch.inDegree(v) == single.inDegree(v));
+    }
+    assert(batch.stats().degreeHistogram == single.stats().degreeHistogram);
+    assert(batch.stats().totalWeight == single.stats().totalWeight);
+
+    vector<EdgeUpdate> removed = {{"a", "b", 0}, {"x", "a", 0},
+                                  {"c", "a", 0}, {"a", "b", 0},
+                                  {"b", "a", 0}, {"d", "c", 0}};
+    done = batch.disconnectBatch(removed);
+    for (size_t i = 0; i < removed.size(); ++i) {
+      assert(done[i] == single.disconnect(removed[i].from, removed[i].to));
+    }
+    assert(!batch.contains("x") && "disconnect does not add vertices");
+    for (VertexId v = 0; v < single.verticesSize(); ++v) {
+      assert(batch.getEdgesAsString(v) == single.getEdgesAsString(v));
+    }
+    assert(batch.edgesSize() == single.edgesSize());
+    assert(batch.stats().degreeHistogram == single.stats().degreeHistogram);
+  }
+  Graph g;
+  assert(g.connectBatch({}).empty() && g.disconnectBatch({}).empty());
+}
+
+// tests the many-to-many distance matrix against dijkstra
+void testDistanceMatrix() {
+  cout << "testDistanceMatrix" << endl;
+  Graph g;
+  if (!g.readFile("graph1.txt")) {
+    return;
+  }
+  vector<string> sources = {"A", "H", "xxx", "A", "X", "G"};
+  vector<string> targets = {"G", "A", "Y", "F", "zzz", "G"};
+  FrozenGraph f = g.freeze();
+  for (int threads : {1, 2, 0}) {
+    DistanceMatrix<int> m = g.distanceMatrix(sources, targets, threads);
+    DistanceMatrix<int> fm = f.distanceMatrix(sources, targets, threads);
+    assert(m.rows == 6 && m.columns == 6 && m.distances == fm.distances);
+    for (int i = 0; i < m.rows; ++i) {
+      map<string, int> weights = g.dijkstra(sources[i]).first;
+      for (int j = 0; j < m.columns; ++j) {
+        int expected = sources[i] == targets[j] ? 0 : -1;
+        if (weights.count(targets[j]) == 1) {
+          expected = weights[targets[j]];
+        }
+        if (!g.contains(sources[i]) || !g.contains(targets[j])) {
+          expected = -1;
+        }
+        assert(m.at(i, j) == expected && "matches dijkstra");
+      }
+    }
+  }
+  DistanceMatrix<int> m = g.distanceMatrix({"A"}, {"G", "F"});
+  assert(m.at(0, 0) == 4 && m.at(0, 1) == 5 && "early exit keeps answers");
+  m = g.distanceMatrix({"A", "B"}, {});
+  assert(m.rows == 2 && m.columns == 0 && m.distances.empty());
+}
+
+// tests contraction hierarchy queries against dijkstra on every pair
+void testContractionHierarchy() {
+  cout << "testContractionHierarchy" << endl;
+  for (string file : {"graph1.txt", "graph3.txt"}) {
+    for (bool directional : {true, false}) {
+      Graph g(directional);
+      if (!g.readFile(file)) {
+        return;
+      }
+      ContractionHierarchy ch(g);
+      assert(ch.verticesSize() == g.verticesSize());
+      assert(ch.contains(g.label(0)) && !ch.contains("xxx"));
+      for (VertexId from = 0; from < g.verticesSize(); ++from) {
+        for (VertexId to = 0; to < g.verticesSize(); ++to) {
+          pair<int, vector<string>> expected =
+              g.shortestPath(g.label(from), g.label(to));
+          pair<int, vector<string>> found =
+              ch.shortestPath(g.label(from), g.label(to));
+          assert(found.first == expected.first && "same cost as dijkstra");
+          if (found.first == -1) {
+            assert(found.second.empty() && "no path when unreachable");
+            continue;
+          }
+          // ties may pick another path, so check it is a real one
+          assert(found.second.front() == g.label(from));
+          assert(found.second.back() == g.label(to));
+          int cost = 0;
+          for (size_t i = 0; i + 1 < found.second.size(); ++i) {
+            VertexId a = g.id(found.second[i]);
+            VertexId b = g.id(found.second[i + 1]);
+            g.forEachEdge(a, [&cost, b](VertexId next, int weight) {
+              cost += next == b ? weight : 0;
+            });
+            assert(g.getEdgesAsString(a).find(found.second[i + 1]) !=
+                   string::npos && "unpacked into original edges");
+          }
+          assert(cost == found.first && "path adds up to its cost");
+        }
+      }
+    }
+  }
+  Graph g;
+  g.connect("a", "b", 1);
+  ContractionHierarchy ch(g);
+  assert(ch.shortestPath("a", "xxx").first == -1 && "missing vertex");
+  assert(ch.shortestPath(0, 7).first == -1 && "invalid id");
+  pair<int, vector<string>> self = ch.shortestPath("a", "a");
+  assert(self.first == 0 && self.second == vector<string>({"a"}));
+
+  // a path that would overflow int is not taken, as in dijkstra
+  Graph far;
+  far.connect("A", "B", INT_MAX - 5);
+  far.connect("B", "C", 10);
+  far.connect("A", "D", 1);
+  far.connect("D", "C", 2);
+  assert(ContractionHierarchy(far).shortestPath("A", "C").first == 3 &&
+         "short way round");
+  far.disconnect("D", "C");
+  ContractionHierarchy farCh(far);
+  assert(farCh.shortestPath("A", "C").first == -1 && "too long");
+  assert(farCh.shortestPath("A", "B").first == INT_MAX - 5 &&
+         farCh.shortestPath("B", "C").first == 10 && "each half is fine");
+}
+
+// tests that readers always see whole batches while a writer publishes
+void testConcurrentGraph() {
+  cout << "testConcurrentGraph" << endl;
+  ConcurrentGraph g(false);
+  ConcurrentGraph::Reader main(g);
+  ConcurrentGraph::Snapshot empty = main.snapshot();
+  assert(empty->verticesSize() == 0 && g.version() == 1);
+  const int BATCHES = 40;
+  const int BATCH = 10;
+  vector<thread> readers;
+  vector<bool> ok(4, true);
+  for (int r = 0; r < 4; ++r) {
+    readers.emplace_back([&g, &ok, r]() {
+      ConcurrentGraph::Reader reader(g);
+      int last = 0;
+      while (last < BATCHES * BATCH) {
+        ConcurrentGraph::Snapshot snap = reader.snapshot();
+        int edges = snap->edgesSize();
+        // a chain v0-v1-...: each batch extends it by BATCH edges
+        if (edges % BATCH != 0 || edges < last ||
+            (edges > 0 &&
+             snap->shortestPath("v0", "v" + to_string(edges)).first !=
+                 edges)) {
+          ok[r] = false;
+          return;
+        }
+        last = edges;
+      }
+    });
+  }
+  for (int b = 0; b < BATCHES; ++b) {
+    vector<EdgeUpdate> batch;
+    for (int i = b * BATCH; i < (b + 1) * BATCH; ++i) {
+      batch.push_back({"v" + to_string(i), "v" + to_string(i + 1), 1});
+    }
+    vector<bool> done = g.connectBatch(batch);
+    assert(done == vector<bool>(BATCH, true) && "batch connected");
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  assert(ok == vector<bool>(4, true) && "readers saw consistent versions");
+  assert(g.version() == BATCHES + 1 && empty->verticesSize() == 0);
+  vector<bool> done = g.disconnectBatch({{"v0", "v1", 0}, {"v0", "v1", 0}});
+  assert(done == vector<bool>({true, false}));
+  g.update([](Graph &writer) { writer.connect("v0", "v1", 3); });
+  assert(main.snapshot()->getEdgesAsString("v0") == "v1(3)");
+  assert(g.version() == BATCHES + 3);
+  // a version held across publishes is still the one that was taken
+  {
+    ConcurrentGraph::Snapshot held = main.snapshot();
+    g.update([](Graph &writer) { writer.disconnect("v0", "v1"); });
+    g.update([](Graph &writer) { writer.connect("v0", "v1", 5); });
+    assert(held->getEdgesAsString("v0") == "v1(3)" && "held version kept");
+    assert(main.snapshot()->getEdgesAsString("v0") == "v1(5)");
+  }
+  assert(empty->verticesSize() == 0 && "first version kept throughout");
+}
+
+// tests the templated visitors: lambdas with local state, early stops
+void testTemplatedVisitors() {
+  cout << "testTemplatedVisitors" << endl;
+  Graph g;
+  if (!g.readFile("graph1.txt")) {
+    return;
+  }
+  VertexId a = g.id("A");
+  string order;
+  g.dfs(a, [&](VertexId v) { order += g.label(v); });
+  globalSS.str("");
+  g.dfs("A", vertexPrinter);
+  assert(order == globalSS.str() && "same order as the pointer version");
+  order.clear();
+  g.bfs(a, [&](VertexId v) { order += g.label(v); });
+  globalSS.str("");
+  g.bfs("A", vertexPrinter);
+  assert(order == globalSS.str() && order == "ABHCGDEF");
+
+  // returning false stops the traversal
+  int seen = 0;
+  g.bfs(a, [&seen](VertexId) { return ++seen < 3; });
+  assert(seen == 3 && "bfs stops at the third vertex");
+  seen = 0;
+  g.dfs(a, [&seen](VertexId) { return ++seen < 2; });
+  assert(seen == 2 && "dfs stops at the second vertex");
+  g.dfs(-1, [&seen](VertexId) { ++seen; });
+  assert(seen == 2 && "no visits from an invalid id");
+
+  Graph u(false);
+  if (!u.readFile("graph1.txt")) {
+    return;
+  }
+  string tree;
+  int total = u.mstPrim(u.id("A"), [&](VertexId from, VertexId to, int w) {
+    tree += u.label(from) + u.label(to) + to_string(w);
+  });
+  globalSS.str("");
+  assert(total == 7 && total == u.mstPrim("A", edgePrinter));
+  assert(tree == "AB1BC1CD1DE1EF1FG1GH1" && "same edges");
+  int edges = 0;
+  int partial = u.mstKruskal(u.id("A"), [&edges](VertexId, VertexId, int) {
+    return ++edges < 2;
+  });
+  assert(edges == 2 && partial == 2 && "two edges of weight 1");
+  assert(u.mstPrim(-1, [](VertexId, VertexId, int) {}) == -1);
+  assert(g.mstKruskal(a, [](VertexId, VertexId, int) {}) == -1 &&
+         "directed graph");
+}
+
+// tests that edges are shown in label order after every kind of change
+void testSortedEdgeCache() {
+  cout << "testSortedEdgeCache" << endl;
+  Graph g(false);
+  g.connect("D", "B", 4);
+  g.connect("D", "A", 1);
+  assert(g.getEdgesAsString("D") == "A(1),B(4)");
+  assert(g.getEdgesAsString("D") == "A(1),B(4)" && "same the second time");
+  g.connect("C", "D", 3);
+  assert(g.getEdgesAsString("D") == "A(1),B(4),C(3)" && "connect seen");
+  g.disconnect("A", "D");
+  assert(g.getEdgesAsString("D") == "B(4),C(3)" && "disconnect seen");
+  g.connectBatch({{"D", "AA", 2}, {"E", "D", 5}});
+  assert(g.getEdgesAsString("D") == "AA(2),B(4),C(3),E(5)" && "batch seen");
+  g.disconnectBatch({{"D", "B", 0}, {"C", "D", 0}});
+  assert(g.getEdgesAsString("D") == "AA(2),E(5)" && "batch removal seen");
+  string order;
+  g.bfs(g.id("D"), [&](VertexId v) { order += g.label(v); });
+  assert(order == "DAAE" && "bfs uses the current edges");
+  g.connect("AA", "B", 1);
+  order.clear();
+  g.dfs(g.id("D"), [&](VertexId v) { order += g.label(v); });
+  assert(order == "DAABE" && "dfs uses the current edges");
+
+  // traversals on several threads sort the edges at the same time
+  Graph big;
+  if (!big.readFile("graph1.txt")) {
+    return;
+  }
+  vector<string> seen(4);
+  vector<thread> workers;
+  for (int i = 0; i < 4; ++i) {
+    workers.emplace_back([&big, &seen, i]() {
+      big.bfs(big.id("A"), [&](VertexId v) { seen[i] += big.label(v); });
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  globalSS.str("");
+  big.bfs("A", vertexPrinter);
+  for (auto const &s : seen) {
+    assert(s == globalSS.str() && "same order on every thread");
+  }
+}
+
+// tests the parallel delta-stepping search against the sequential one
+void testDeltaStepping() {
+  cout << "testDeltaStepping" << endl;
+  Graph g4;
+  if (!g4.readFile("graph4.txt")) {
+    return;
+  }
+  auto expected = g4.dijkstra("A");
+  int threadCounts[] = {1, 2, 3, 0};
+  double widths[] = {0, 0.5, 3, 100};
+  for (int threads : threadCounts) {
+    for (double width : widths) {
+      DijkstraOptions options;
+      options.parallel = true;
+      options.threads = threads;
+      options.bucketWidth = width;
+      auto p = g4.dijkstra("A", options);
+      assert(p.first == expected.first && "same weights as dijkstra");
+      assert(g4.freeze().dijkstra("A", options).first == expected.first &&
+             "same weights on the frozen graph");
+      assert(g4.shortestPath("A", "K", options).first == 4 && "A to K is 4");
+      assert(g4.shortestPath("A", "D", options).second ==
+                 vector<string>({"A", "B", "D"}) &&
+             "A to D via B");
+    }
+  }
+
+  // zero weights and many equal paths, previous must still be a tree of
+  // shortest paths
+  Graph g(false);
+  const int SIDE = 20;
+  for (int r = 0; r < SIDE; ++r) {
+    for (int c = 0; c < SIDE; ++c) {
+      string v = to_string(r) + "," + to_string(c);
+      if (c + 1 < SIDE) {
+        g.connect(v, to_string(r) + "," + to_string(c + 1), (r * c) % 3);
+      }
+      if (r + 1 < SIDE) {
+        g.connect(v, to_string(r + 1) + "," + to_string(c), (r + c) % 4);
+      }
+    }
+  }
+  VertexId start = g.id("0,0");
+  auto sequential = g.dijkstra(start);
+  DijkstraOptions options;
+  options.parallel = true;
+  options.threads = 4;
+  auto parallel = g.dijkstra(start, options);
+  assert(parallel.first == sequential.first && "same distances");
+  for (VertexId v = 0; v < g.verticesSize(); ++v) {
+    VertexId p = parallel.second[v];
+    assert((p == -1) == (v == start) && "every vertex but start has one");
+    if (p != -1) {
+      int weight = -1;
+      g.forEachEdge(p, [&](VertexId to, int w) {
+        weight = to == v ? w : weight;
+      });
+      assert(parallel.first[p] + weight == parallel.first[v] &&
+             "previous is on a shortest path");
+    }
+  }
+  assert(g.dijkstra(start, options) == parallel && "same on every run");
+
+  // width 1 with weights up to 1e9 spans far more buckets than the ring
+  // holds, distant vertices go through the overflow heap
+  Graph far(false);
+  const int FAR = 300;
+  for (int i = 0; i < FAR; ++i) {
+    far.connect("f" + to_string(i), "f" + to_string((i + 1) % FAR),
+                1 + (i * 7919LL) % 1000000000);
+    far.connect("f" + to_string(i), "f" + to_string((i * 37 + 11) % FAR),
+                1 + (i * 104729LL) % 100000);
+  }
+  options.bucketWidth = 1;
+  for (int threads : threadCounts) {
+    options.threads = threads;
+    assert(far.dijkstra("f0", options).first == far.dijkstra("f0").first &&
+           "narrow buckets give the same weights");
+    for (int i = 1; i < FAR; i += 37) {
+      string to = "f" + to_string(i);
+      assert(far.shortestPath("f0", to, options).first ==
+                 far.shortestPath("f0", to).first &&
+             "narrow buckets stop at the right cost");
+    }
+  }
+
+  // X waits in overflow while Y, reached later through A, fits the ring
+  Graph jump;
+  jump.connect("S", "X", 70);
+  jump.connect("S", "A", 9);
+  jump.connect("A", "Y", 63);
+  jump.connect("X", "Y", 1);
+  options.threads = 1;
+  assert(jump.shortestPath("S", "Y", options).first == 71 &&
+         "overflow bucket settled before a later ring bucket");
+}
+
+// tests keeping a minimum spanning forest up to date
+void testDynamicMst() {
+  cout << "testDynamicMst" << endl;
+  Graph g(false);
+  if (!g.readFile("graph1.txt")) {
+    return;
+  }
+  DynamicMst mst(g);
+  assert(mst.totalWeight() == 17 && mst.edgesSize() == 8 && "A-H left out");
+  globalSS.str("");
+  mst.edges(edgePrinter);
+  assert(globalSS.str() ==
+             "[AB 1][BC 1][CD 1][DE 1][EF 1][FG 1][GH 1][XY 10]" &&
+         "forest edges in label order");
+  assert(mst.connect("A", "D", 5) && g.edgesSize() == 10);
+  assert(mst.totalWeight() == 17 && !mst.contains(g.id("A"), g.id("D")) &&
+         "heavier than every edge of the cycle");
+  assert(!mst.connect("A", "D", 1) && "already connected");
+  assert(mst.connect("A", "E", 0) && mst.totalWeight() == 16 &&
+         mst.contains(g.id("A"), g.id("E")) && "replaces an edge of weight 1");
+  assert(mst.disconnect("X", "Y") && mst.totalWeight() == 6 &&
+         mst.edgesSize() == 7 && "forest loses a tree");
+  assert(!mst.disconnect("X", "Y") && "already gone");
+  // every removal of a tree edge needs a replacement from the cycle
+  vector<string> order = {"A", "B", "C", "D", "E", "F", "G", "H"};
+  for (size_t i = 0; i + 1 < order.size(); ++i) {
+    if (mst.contains(g.id(order[i]), g.id(order[i + 1]))) {
+      mst.disconnect(order[i], order[i + 1]);
+      break;
+    }
+  }
+  globalSS.str("");
+  assert(mst.totalWeight() == g.mstKruskal("A", edgePrinter) &&
+         "same weight as a new tree");
+  assert(mst.connect("Z", "A", 2) && mst.edgesSize() == 8 &&
+         "new vertex joins the tree");
+
+  Graph directed;
+  DynamicMst none(directed);
+  assert(none.totalWeight() == -1 && !none.connect("A", "B", 1) &&
+         directed.verticesSize() == 0 && "directed graphs are refused");
+}
+
+// tests repairing shortest paths as the graph changes
+void testDynamicShortestPaths() {
+  cout << "testDynamicShortestPaths" << endl;
+  Graph g;
+  if (!g.readFile("graph4.txt")) {
+    return;
+  }
+  DynamicShortestPaths paths(g);
+  assert(paths.addSource("A") && !paths.addSource("A") &&
+         !paths.addSource("xxx") && "each vertex is a source once");
+  assert(paths.dijkstra("A") == g.dijkstra("A") && "starts from dijkstra");
+  assert(paths.dijkstra("B").first.empty() && "B is not a source");
+
+  g.connect("A", "D", 1);
+  auto repaired = paths.dijkstra("A");
+  assert(map2string(repaired.first) ==
+             "[B:6][D:1][E:2][F:2][G:3][H:8][I:3][J:5][K:2][L:11]" &&
+         "D and K are closer");
+  assert(repaired.second["K"] == "D" && "K through D");
+  g.disconnect("A", "E");
+  repaired = paths.dijkstra("A");
+  assert(repaired.first == g.dijkstra("A").first && "E and below repaired");
+  assert(repaired.second["E"] == "B" && "E through B");
+  g.disconnect("B", "H");
+  assert(paths.dijkstra("A") == g.dijkstra("A") && "not a tree edge");
+  g.connectBatch({{"A", "E", 2}, {"D", "L", 1}, {"Z", "A", 1}});
+  assert(paths.dijkstra("A").first == g.dijkstra("A").first && "batch");
+  g.disconnectBatch({{"A", "D", 0}, {"A", "F", 0}});
+  assert(paths.dijkstra("A").first == g.dijkstra("A").first && "removals");
+  assert(paths.addSource("Z") &&
+         paths.dijkstra("Z").first == g.dijkstra("Z").first);
+  assert(paths.removeSource("A") && !paths.removeSource("A") &&
+         paths.dijkstra("A").first.empty() && "A no longer kept");
+
+  // a DynamicMst sees changes made straight on the graph
+  Graph u(false);
+  if (!u.readFile("graph1.txt")) {
+    return;
+  }
+  DynamicMst mst(u);
+  DynamicShortestPaths fromA(u);
+  fromA.addSource("A");
+  u.connect("A", "E", 0);
+  assert(mst.totalWeight() == 16 && "cycle through the new edge");
+  assert(fromA.dijkstra("A").first == u.dijkstra("A").first &&
+         "undirected repair");
+
+  // a graph built while observed, every edge brings a new vertex
+  Graph chain;
+  DynamicShortestPaths fromStart(chain);
+  chain.add("c0");
+  fromStart.addSource("c0");
+  for (int i = 1; i < 2000; ++i) {
+    chain.connect("c" + to_string(i - 1), "c" + to_string(i), i % 5);
+  }
+  chain.connect("c0", "c1500", 1);
+  assert(fromStart.dijkstra("c0") == chain.dijkstra("c0") &&
+         "grown one vertex at a time");
+}
+
+// tests Tarjan and parallel SCC agree and the condensation is a DAG
+void testStronglyConnected() {
+  cout << "testStronglyConnected" << endl;
+  Graph g;
+  for (string label : {"a", "b", "c", "d", "e", "f"}) {
+    g.add(label);
+  }
+  g.connectBatch({{"a", "b", 1}, {"b", "c", 1}, {"c", "a", 1},
+                  {"c", "d", 1}, {"d", "e", 1}, {"e", "d", 1}});
+  SccResult scc = g.stronglyConnectedComponents();
+  assert(scc.count == 3 && "abc, de and f");
+  assert(scc.component[g.id("a")] == 0 && scc.component[g.id("c")] == 0 &&
+         scc.component[g.id("d")] == 1 && scc.component[g.id("e")] == 1 &&
+         scc.component[g.id("f")] == 2 && "topological, smallest first");
+  assert(scc.offsets == vector<int>({0, 1, 1, 1}) &&
+         scc.targets == vector<int>(1, 1) && "abc -> de, once");
+  SccResult parallel = g.stronglyConnectedComponents(2);
+  assert(parallel.component == scc.component &&
+         parallel.targets == scc.targets && "same numbering in parallel");
+  g.connect("e", "a", 1);
+  assert(g.stronglyConnectedComponents(2).count == 2 && "abcde joined");
+
+  Graph g4;
+  if (!g4.readFile("graph4.txt")) {
+    return;
+  }
+  scc = g4.stronglyConnectedComponents();
+  assert(scc.count == g4.verticesSize() && "graph4 has no cycles");
+  for (VertexId v = 0; v < g4.verticesSize(); ++v) {
+    g4.forEachEdge(v, [&scc, v](VertexId to, int) {
+      assert(scc.component[v] < scc.component[to] && "edges go forward");
+    });
+  }
+  FrozenGraph frozen = g4.freeze();
+  SccResult tarjan = frozen.stronglyConnectedComponents();
+  assert(tarjan.count == scc.count &&
+         frozen.stronglyConnectedComponents(0).component ==
+             tarjan.component &&
+         "frozen graph, both engines");
+}
+
+// tests edges are kept in flat arrays ordered by id, however they came
+void testFlatAdjacency() {
+  cout << "testFlatAdjacency" << endl;
+  Graph g(false);
+  map<VertexId, int> expected;
+  for (int i = 0; i < 40; ++i) {
+    g.add(to_string(i));
+  }
+  for (int i = 1; i < 40; i += 3) {
+    g.connect(0, (i * 7) % 39 + 1, i);
+    expected[(i * 7) % 39 + 1] = i;
+  }
+  vector<EdgeUpdate> batch;
+  for (int i = 39; i > 0; i -= 2) {
+    batch.push_back({"0", to_string(i), 100 + i});
+    batch.push_back({to_string(i), "0", 200 + i});
+    expected.insert(make_pair(i, 100 + i));
+  }
+  g.connectBatch(batch);
+  g.disconnectBatch({{"5", "0", 0}, {"0", "6", 0}});
+  g.disconnect(0, 7);
+  expected.erase(5);
+  expected.erase(6);
+  expected.erase(7);
+  vector<pair<VertexId, int>> edges;
+  g.forEachEdge(0, [&edges](VertexId to, int weight) {
+    edges.emplace_back(to, weight);
+  });
+  vector<pair<VertexId, int>> inOrder(expected.begin(), expected.end());
+  assert(edges == inOrder && "ascending ids, first weight wins");
+  assert(g.vertexDegree(0) == static_cast<int>(expected.size()) &&
+         g.inDegree(0) == g.vertexDegree(0) && "degrees");
+  for (auto const &edge : expected) {
+    assert(g.vertexDegree(edge.first) == 1 && "other end has one edge");
+    assert(!g.connect(edge.first, 0, 1) && "no duplicate from either end");
+  }
+}
+
+// tests weights other than int and paths too long for their length type
+void testWeightTypes() {
+  cout << "testWeightTypes" << endl;
+  BasicGraph<double> real(false);
+  real.connect("A", "B", 1.5);
+  real.connect("B", "C", 2.25);
+  real.connect("A", "C", 4);
+  assert(real.getEdgesAsString("B") == "A(1.5),C(2.25)");
+  assert(real.dijkstra("A").first["C"] == 3.75 && "through B");
+  double tree = real.mstPrim("A", [](const string &, const string &,
+                                     double) {});
+  assert(tree == 3.75 && real.stats().totalWeight == 7.75);
+
+  // 16-bit weights, paths summed in int
+  BasicGraph<uint16_t> small;
+  small.connect("A", "B", 60000);
+  small.connect("B", "C", 60000);
+  assert(small.shortestPath("A", "C").first == 120000 && "no wrap");
+
+  BasicGraph<int64_t> wide;
+  wide.connectBatch({{"A", "B", 3000000000LL}, {"B", "C", 3000000000LL}});
+  assert(wide.dijkstra("A").first["C"] == 6000000000LL);
+
+  // an int path that would overflow is not taken
+  Graph g;
+  g.connect("A", "B", INT_MAX - 5);
+  g.connect("B", "C", 10);
+  g.connect("A", "D", 1);
+  g.connect("D", "C", 2);
+  assert(g.shortestPath("A", "C").first == 3 && "short way round");
+  g.disconnect("D", "C");
+  assert(g.shortestPath("A", "C").first == -1 && "too long, unreachable");
+  assert(g.dijkstra("A").first.count("C") == 0);
+
+  // the text format reads into any weight type
+  Graph ints(false);
+  BasicGraph<double> doubles(false);
+  if (!ints.readFile("graph1.txt") ||
+      !doubles.readFileParallel("graph1.txt", 2)) {
+    return;
+  }
+  auto fromInts = ints.dijkstra("A").first;
+  auto fromDoubles = doubles.dijkstra("A").first;
+  assert(fromInts.size() == fromDoubles.size());
+  for (auto const &entry : fromInts) {
+    assert(fromDoubles[entry.first] == entry.second && "same costs");
+  }
+}
+
+// stats handed to statsSink, filled only when built with -DGRAPH_STATS
+int sinkCalls = 0;
+QueryStats sinkStats;
+
+void statsSink(const QueryStats &stats) {
+  ++sinkCalls;
+  sinkStats = stats;
+}
+
+// tests the counters, which are only there when built with -DGRAPH_STATS
+void testInstrumentation() {
+  cout << "testInstrumentation" << endl;
+  Graph g;
+  if (!g.readFile("graph0.txt")) {
+    return;
+  }
+  setQueryStatsSink(statsSink);
+  sinkCalls = 0;
+  g.dijkstra("A");
+#ifdef GRAPH_STATS
+  QueryStats stats = lastQueryStats();
+  assert(sinkCalls == 1 && "nested id dijkstra is part of the outer query");
+  assert(string(stats.algorithm) == "dijkstra");
+  assert(stats.settled == 3 && stats.relaxed == 3 && stats.heapPops == 3);
+  assert(stats.heapPushes == 4 && "A, B, C at 8, then C lowered to 4");
+  assert(stats.seconds >= stats.phaseSeconds[int(Phase::Output)]);
+  Graph u(false);
+  u.readFile("graph2.txt");
+  u.mstKruskal("A", edgePrinter);
+  stats = lastQueryStats();
+  assert(string(stats.algorithm) == "mstKruskal" && stats.unionFinds > 0);
+  assert(stats.phaseSeconds[int(Phase::Setup)] > 0);
+  Graph h(true, AllocationPolicy::Heap);
+  h.connect("a", "b", 1);
+  h.shortestPath("a", "b");
+  assert(sinkStats.allocations == 0 && "a query does not allocate nodes");
+  h.readFile("graph0.txt");
+  assert(sinkStats.allocations > 0 && "readFile allocates vertices");
+  assert(string(sinkStats.algorithm) == "readFile");
+#else
+  assert(sinkCalls == 0 && lastQueryStats().algorithm == nullptr);
+#endif
+  setQueryStatsSink(nullptr);
+}
+
 // runs all test methods
 void testAll() {
   testGraphBasic();
@@ -312,4 +1471,28 @@ void testAll() {
   testGraph4Directed();
   testGraph4Undirected();
   testGraph1();
+  testFrozenGraph();
+  testShortestPath();
+  testBinaryFormat();
+  testReadFileParallel();
+  testVertexIds();
+  testAllocationPolicy();
+  testKruskal();
+  testMstParallel();
+  testBfsLevels();
+  testDfsNumbering();
+  testGraphStats();
+  testBatch();
+  testDistanceMatrix();
+  testContractionHierarchy();
+  testConcurrentGraph();
+  testInstrumentation();
+  testTemplatedVisitors();
+  testSortedEdgeCache();
+  testDeltaStepping();
+  testDynamicMst();
+  testDynamicShortestPaths();
+  testStronglyConnected();
+  testFlatAdjacency();
+  testWeightTypes();
 }
\ No newline at end of file
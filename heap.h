@@ -0,0 +1,271 @@
+/**
+ * Indexed min-heaps over vertex ids 0..n-1, used by the shortest path
+ * engine. Every heap has the same interface, so the engine can be
+ * instantiated with any of them:
+ *   explicit Heap(int n)      // empty heap for ids 0..n-1
+ *   bool empty() const
+ *   bool contains(int id) const
+ *   void push(int id, Key key) // insert id, or lower the key of id
+ *   Key topKey() const         // smallest key, heap must not be empty
+ *   int pop()                  // remove and return the id with smallest key
+ *   void clear()               // remove every id, keeps the memory
+ */
+
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "instrument.h"
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// d-ary heap, Arity 2 is the classic binary heap
+// a wider heap is shallower, so push does fewer swaps at the cost of
+// more comparisons in pop
+template <typename Key, int Arity> class DAryHeap {
+private:
+  vector<int> heap;   // ids in heap order
+  vector<int> pos;    // index of id in heap, -1 if not in heap
+  vector<Key> keys;   // key of each id in heap
+
+  // move the entry at index i up until its parent is not larger
+  void siftUp(int i) {
+    int id = heap[i];
+    while (i > 0) {
+      int parent = (i - 1) / Arity;
+      if (!(keys[id] < keys[heap[parent]])) {
+        break;
+      }
+      heap[i] = heap[parent];
+      pos[heap[i]] = i;
+      i = parent;
+    }
+    heap[i] = id;
+    pos[id] = i;
+  }
+
+  // move the entry at index i down until no child is smaller
+  void siftDown(int i) {
+    int id = heap[i];
+    int size = heap.size();
+    while (true) {
+      int first = i * Arity + 1;
+      if (first >= size) {
+        break;
+      }
+      int best = first;
+      int last = first + Arity < size ? first + Arity : size;
+      for (int c = first + 1; c < last; ++c) {
+        if (keys[heap[c]] < keys[heap[best]]) {
+          best = c;
+        }
+      }
+      if (!(keys[heap[best]] < keys[id])) {
+        break;
+      }
+      heap[i] = heap[best];
+      pos[heap[i]] = i;
+      i = best;
+    }
+    heap[i] = id;
+    pos[id] = i;
+  }
+
+public:
+  explicit DAryHeap(int n) : pos(n, -1), keys(n) {}
+
+  bool empty() const { return heap.empty(); }
+
+  bool contains(int id) const { return pos[id] != -1; }
+
+  // insert id, or lower the key of id if it is already in the heap
+  void push(int id, Key key) {
+    if (pos[id] == -1) {
+      GRAPH_COUNT(heapPushes, 1);
+      heap.push_back(id);
+      keys[id] = key;
+      siftUp(heap.size() - 1);
+    } else if (key < keys[id]) {
+      GRAPH_COUNT(heapPushes, 1);
+      keys[id] = key;
+      siftUp(pos[id]);
+    }
+  }
+
+  Key topKey() const { return keys[heap[0]]; }
+
+  // remove and return the id with the smallest key
+  int pop() {
+    GRAPH_COUNT(heapPops, 1);
+    int top = heap[0];
+    pos[top] = -1;
+    int last = heap.back();
+    heap.pop_back();
+    if (!heap.empty()) {
+      heap[0] = last;
+      pos[last] = 0;
+      siftDown(0);
+    }
+    return top;
+  }
+
+  // remove every id, O(size) rather than O(n)
+  void clear() {
+    for (int id : heap) {
+      pos[id] = -1;
+    }
+    heap.clear();
+  }
+
+  // allow ids 0..n-1 from now on, n must not be smaller than before
+  // the ids in the heap stay, and growing one id at a time is amortized
+  // O(1) like a vector
+  void resize(int n) {
+    pos.resize(n, -1);
+    keys.resize(n);
+  }
+};
+
+template <typename Key> using BinaryHeap = DAryHeap<Key, 2>;
+
+template <typename Key> using FourAryHeap = DAryHeap<Key, 4>;
+
+// pairing heap, O(1) push and decrease-key, O(log n) amortized pop
+// nodes live in arrays indexed by id, so no allocation after construction
+template <typename Key> class PairingHeap {
+private:
+  struct Node {
+    int child;   // leftmost child
+    int sibling; // next sibling to the right
+    int prev;    // parent if leftmost child, otherwise left sibling
+    Key key;
+    bool inHeap;
+  };
+  vector<Node> nodes;
+  int root;
+  int count;
+  vector<int> scratch; // roots collected during pop
+
+  // link two roots, @return the root of the merged tree
+  int meld(int a, int b) {
+    if (a == -1) {
+      return b;
+    }
+    if (b == -1) {
+      return a;
+    }
+    if (nodes[b].key < nodes[a].key) {
+      swap(a, b);
+    }
+    // b becomes the leftmost child of a
+    nodes[b].prev = a;
+    nodes[b].sibling = nodes[a].child;
+    if (nodes[a].child != -1) {
+      nodes[nodes[a].child].prev = b;
+    }
+    nodes[a].child = b;
+    nodes[a].sibling = -1;
+    nodes[a].prev = -1;
+    return a;
+  }
+
+  // detach the subtree rooted at id from its parent or siblings
+  void cut(int id) {
+    Node &node = nodes[id];
+    if (nodes[node.prev].child == id) {
+      nodes[node.prev].child = node.sibling;
+    } else {
+      nodes[node.prev].sibling = node.sibling;
+    }
+    if (node.sibling != -1) {
+      nodes[node.sibling].prev = node.prev;
+    }
+    node.sibling = -1;
+    node.prev = -1;
+  }
+
+public:
+  explicit PairingHeap(int n) : nodes(n), root(-1), count(0) {
+    for (auto &node : nodes) {
+      node.child = node.sibling = node.prev = -1;
+      node.inHeap = false;
+    }
+  }
+
+  bool empty() const { return count == 0; }
+
+  bool contains(int id) const { return nodes[id].inHeap; }
+
+  // insert id, or lower the key of id if it is already in the heap
+  void push(int id, Key key) {
+    Node &node = nodes[id];
+    if (!node.inHeap) {
+      GRAPH_COUNT(heapPushes, 1);
+      node.child = node.sibling = node.prev = -1;
+      node.key = key;
+      node.inHeap = true;
+      ++count;
+      root = meld(root, id);
+    } else if (key < node.key) {
+      GRAPH_COUNT(heapPushes, 1);
+      node.key = key;
+      if (id != root) {
+        cut(id);
+        root = meld(root, id);
+      }
+    }
+  }
+
+  Key topKey() const { return nodes[root].key; }
+
+  // remove and return the id with the smallest key
+  // children are paired left to right, then melded right to left
+  int pop() {
+    GRAPH_COUNT(heapPops, 1);
+    int top = root;
+    scratch.clear();
+    for (int c = nodes[top].child; c != -1;) {
+      int next = nodes[c].sibling;
+      nodes[c].sibling = nodes[c].prev = -1;
+      scratch.push_back(c);
+      c = next;
+    }
+    size_t pairs = 0;
+    for (size_t i = 0; i + 1 < scratch.size(); i += 2) {
+      scratch[pairs++] = meld(scratch[i], scratch[i + 1]);
+    }
+    if (scratch.size() % 2 == 1) {
+      scratch[pairs++] = scratch.back();
+    }
+    root = -1;
+    while (pairs > 0) {
+      root = meld(scratch[--pairs], root);
+    }
+    nodes[top].child = -1;
+    nodes[top].inHeap = false;
+    --count;
+    return top;
+  }
+
+  // remove every id, walks the remaining trees rather than all n nodes
+  void clear() {
+    scratch.clear();
+    if (root != -1) {
+      scratch.push_back(root);
+    }
+    while (!scratch.empty()) {
+      int id = scratch.back();
+      scratch.pop_back();
+      for (int c = nodes[id].child; c != -1; c = nodes[c].sibling) {
+        scratch.push_back(c);
+      }
+      nodes[id].child = nodes[id].sibling = nodes[id].prev = -1;
+      nodes[id].inHeap = false;
+    }
+    root = -1;
+    count = 0;
+  }
+};
+
+#endif // HEAP_H
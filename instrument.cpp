@@ -0,0 +1,46 @@
+#include "instrument.h"
+#include <atomic>
+
+using namespace std;
+
+namespace {
+// where finished queries are reported, nullptr for nowhere
+atomic<void (*)(const QueryStats &)> statsSink(nullptr);
+
+// stats of the last query finished on each thread
+thread_local QueryStats lastStats;
+} // namespace
+
+thread_local QueryStats *QueryScope::active = nullptr;
+
+// call sink with the stats of every query once it is done
+void setQueryStatsSink(void sink(const QueryStats &stats)) {
+  statsSink.store(sink);
+}
+
+// @return stats of the last query finished on this thread
+QueryStats lastQueryStats() { return lastStats; }
+
+// start recording, unless a query is already running on this thread
+QueryScope::QueryScope(const char *algorithm)
+    : outermost(active == nullptr), start(chrono::steady_clock::now()) {
+  if (outermost) {
+    stats.algorithm = algorithm;
+    active = &stats;
+  }
+}
+
+// report the stats to the sink
+QueryScope::~QueryScope() {
+  if (!outermost) {
+    return;
+  }
+  chrono::duration<double> spent = chrono::steady_clock::now() - start;
+  stats.seconds = spent.count();
+  active = nullptr;
+  lastStats = stats;
+  void (*sink)(const QueryStats &) = statsSink.load();
+  if (sink != nullptr) {
+    sink(stats);
+  }
+}
@@ -0,0 +1,120 @@
+/**
+ * Optional counters for the graph algorithms.
+ * Build with -DGRAPH_STATS to turn them on. Each query then records how
+ * many vertices it settled, edges it relaxed, heap pushes and pops,
+ * union-find lookups and node allocations it made, and how long each of
+ * its phases took. When a query finishes its QueryStats are handed to
+ * the sink set with setQueryStatsSink and kept for lastQueryStats.
+ * Without GRAPH_STATS the macros below expand to nothing, so the
+ * algorithms compile exactly as if the counters were not there.
+ *
+ * Counters are kept per thread: work done on helper threads by the
+ * multi-threaded algorithms is not counted, only their total time is.
+ */
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <chrono>
+
+using namespace std;
+
+// parts of a query that are timed separately
+enum class Phase {
+  Setup,  // turning labels into ids, collecting and sorting edges
+  Search, // the main loop of the algorithm
+  Output, // turning the result back into labels, maps and visit calls
+  Count   // number of phases, not a phase
+};
+
+// what one query did
+struct QueryStats {
+  const char *algorithm; // name of the Graph method, nullptr if none yet
+  long long settled;     // vertices taken off the heap or queue
+  long long relaxed;     // edges looked at from a settled vertex
+  long long heapPushes;  // heap inserts and decrease-keys
+  long long heapPops;
+  long long unionFinds;  // DisjointSets::find calls
+  long long allocations; // vertex and edge nodes allocated
+  double seconds;        // wall time of the whole query
+  double phaseSeconds[static_cast<int>(Phase::Count)];
+
+  QueryStats()
+      : algorithm(nullptr), settled(0), relaxed(0), heapPushes(0),
+        heapPops(0), unionFinds(0), allocations(0), seconds(0),
+        phaseSeconds() {}
+};
+
+// call sink with the stats of every query once it is done, on the thread
+// that ran it; nullptr stops the calls
+void setQueryStatsSink(void sink(const QueryStats &stats));
+
+// @return stats of the last query finished on this thread
+QueryStats lastQueryStats();
+
+// the stats of the query running on this thread while it is in scope
+// a query started inside another one is counted as part of the outer one
+class QueryScope {
+private:
+  QueryStats stats;
+  bool outermost;
+  chrono::steady_clock::time_point start;
+
+public:
+  // stats of the query running on this thread, nullptr if none
+  static thread_local QueryStats *active;
+
+  explicit QueryScope(const char *algorithm);
+
+  QueryScope(const QueryScope &other) = delete;
+
+  QueryScope &operator=(const QueryScope &other) = delete;
+
+  // report the stats to the sink
+  ~QueryScope();
+};
+
+// adds the time it is in scope to one phase of the active query
+class PhaseTimer {
+private:
+  Phase phase;
+  chrono::steady_clock::time_point start;
+
+public:
+  explicit PhaseTimer(Phase phase)
+      : phase(phase), start(chrono::steady_clock::now()) {}
+
+  PhaseTimer(const PhaseTimer &other) = delete;
+
+  PhaseTimer &operator=(const PhaseTimer &other) = delete;
+
+  ~PhaseTimer() {
+    if (QueryScope::active != nullptr) {
+      chrono::duration<double> spent = chrono::steady_clock::now() - start;
+      QueryScope::active->phaseSeconds[static_cast<int>(phase)] +=
+          spent.count();
+    }
+  }
+};
+
+#ifdef GRAPH_STATS
+// record the rest of the enclosing block as a query named algorithm
+#define GRAPH_QUERY(algorithm) QueryScope graphQueryScope(algorithm)
+// time the rest of the enclosing block as phase
+#define GRAPH_PHASE(phase) PhaseTimer graphPhaseTimer(phase)
+// add n to one counter of the active query
+#define GRAPH_COUNT(counter, n)                                            \
+  do {                                                                     \
+    if (QueryScope::active != nullptr) {                                   \
+      QueryScope::active->counter += (n);                                  \
+    }                                                                      \
+  } while (false)
+#else
+#define GRAPH_QUERY(algorithm)
+#define GRAPH_PHASE(phase)
+#define GRAPH_COUNT(counter, n)                                            \
+  do {                                                                     \
+  } while (false)
+#endif
+
+#endif // INSTRUMENT_H
@@ -0,0 +1,27 @@
+#include "labeltable.h"
+
+using namespace std;
+
+// @return id of label, -1 if it has not been interned
+VertexId LabelTable::find(const string &label) const {
+  auto found = index.find(&label);
+  return found == index.end() ? -1 : found->second;
+}
+
+// @return id of label, added with the next free id if necessary
+VertexId LabelTable::intern(const string &label) {
+  auto found = index.find(&label);
+  if (found != index.end()) {
+    return found->second;
+  }
+  VertexId id = labels.size();
+  labels.push_back(label);
+  index[&labels.back()] = id;
+  return id;
+}
+
+// @return label with the given id
+const string &LabelTable::label(VertexId id) const { return labels[id]; }
+
+// @return number of interned labels
+int LabelTable::size() const { return labels.size(); }
@@ -0,0 +1,60 @@
+/**
+ * A LabelTable interns vertex labels.
+ * Every distinct label is stored once and given a dense integer id in
+ * order of first appearance, so hot loops can work on ids and only turn
+ * them back into labels at the edges of the API.
+ */
+
+#ifndef LABELTABLE_H
+#define LABELTABLE_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+// dense integer handle for a vertex, -1 means no vertex
+using VertexId = int;
+
+class LabelTable {
+private:
+  // hash and compare the strings the keys point to
+  struct Hash {
+    size_t operator()(const string *label) const {
+      return hash<string>()(*label);
+    }
+  };
+  struct Equal {
+    bool operator()(const string *a, const string *b) const {
+      return *a == *b;
+    }
+  };
+
+  // deque never moves its elements, so the index can point into it
+  deque<string> labels;
+  unordered_map<const string *, VertexId, Hash, Equal> index;
+
+public:
+  LabelTable() = default;
+
+  // copy not allowed, the index points into labels
+  LabelTable(const LabelTable &other) = delete;
+
+  // assignment not allowed
+  LabelTable &operator=(const LabelTable &other) = delete;
+
+  // @return id of label, -1 if it has not been interned
+  VertexId find(const string &label) const;
+
+  // @return id of label, added with the next free id if necessary
+  VertexId intern(const string &label);
+
+  // @return label with the given id
+  const string &label(VertexId id) const;
+
+  // @return number of interned labels
+  int size() const;
+};
+
+#endif // LABELTABLE_H
@@ -0,0 +1,206 @@
+/**
+ * LinkCutForest keeps a forest of rooted trees over nodes with integer
+ * values (Sleator and Tarjan). Linking two trees, cutting an edge,
+ * asking whether two nodes are in the same tree and finding the node
+ * with the largest value on the path between two nodes all take
+ * O(log n) amortized time.
+ * Each tree is stored as a set of preferred paths, each path a splay
+ * tree ordered from the root down; a flag on a splay node reverses its
+ * subtree lazily, which is how any node is made the root of its tree.
+ */
+
+#ifndef LINKCUT_H
+#define LINKCUT_H
+
+#include <vector>
+
+using namespace std;
+
+class LinkCutForest {
+private:
+  struct Node {
+    int parent; // splay parent, or path parent for the top of a path
+    int left;
+    int right;
+    bool flip;  // children still to be swapped
+    int value;
+    int best;   // node with the largest value in this splay subtree
+  };
+
+  vector<Node> nodes;
+  // removed nodes, reused by add
+  vector<int> unused;
+  // nodes from a splay root down to the node being splayed
+  vector<int> path;
+
+  // @return true if x is the root of its splay tree
+  bool isSplayRoot(int x) const {
+    int p = nodes[x].parent;
+    return p == -1 || (nodes[p].left != x && nodes[p].right != x);
+  }
+
+  // swap the children of x if it is flipped, pass the flip on
+  void push(int x) {
+    Node &node = nodes[x];
+    if (node.flip) {
+      swap(node.left, node.right);
+      if (node.left != -1) {
+        nodes[node.left].flip = !nodes[node.left].flip;
+      }
+      if (node.right != -1) {
+        nodes[node.right].flip = !nodes[node.right].flip;
+      }
+      node.flip = false;
+    }
+  }
+
+  // recompute best of x from its children
+  void update(int x) {
+    Node &node = nodes[x];
+    node.best = x;
+    if (node.left != -1 &&
+        nodes[nodes[node.left].best].value > nodes[node.best].value) {
+      node.best = nodes[node.left].best;
+    }
+    if (node.right != -1 &&
+        nodes[nodes[node.right].best].value > nodes[node.best].value) {
+      node.best = nodes[node.right].best;
+    }
+  }
+
+  // move x above its splay parent
+  void rotate(int x) {
+    int p = nodes[x].parent;
+    int g = nodes[p].parent;
+    bool parentIsRoot = isSplayRoot(p);
+    if (nodes[p].left == x) {
+      nodes[p].left = nodes[x].right;
+      if (nodes[p].left != -1) {
+        nodes[nodes[p].left].parent = p;
+      }
+      nodes[x].right = p;
+    } else {
+      nodes[p].right = nodes[x].left;
+      if (nodes[p].right != -1) {
+        nodes[nodes[p].right].parent = p;
+      }
+      nodes[x].left = p;
+    }
+    nodes[p].parent = x;
+    nodes[x].parent = g;
+    if (!parentIsRoot) {
+      if (nodes[g].left == p) {
+        nodes[g].left = x;
+      } else {
+        nodes[g].right = x;
+      }
+    }
+    update(p);
+    update(x);
+  }
+
+  // make x the root of its splay tree
+  void splay(int x) {
+    path.clear();
+    for (int y = x;; y = nodes[y].parent) {
+      path.push_back(y);
+      if (isSplayRoot(y)) {
+        break;
+      }
+    }
+    for (int i = path.size() - 1; i >= 0; --i) {
+      push(path[i]);
+    }
+    while (!isSplayRoot(x)) {
+      int p = nodes[x].parent;
+      if (!isSplayRoot(p)) {
+        int g = nodes[p].parent;
+        bool zigZig = (nodes[g].left == p) == (nodes[p].left == x);
+        rotate(zigZig ? p : x);
+      }
+      rotate(x);
+    }
+  }
+
+  // make the path from the root of the tree to x one splay tree with x
+  // at its top and nothing below x on the path
+  void access(int x) {
+    int below = -1;
+    for (int y = x; y != -1; y = nodes[y].parent) {
+      splay(y);
+      nodes[y].right = below;
+      update(y);
+      below = y;
+    }
+    splay(x);
+  }
+
+  // make x the root of its tree
+  void makeRoot(int x) {
+    access(x);
+    nodes[x].flip = !nodes[x].flip;
+    push(x);
+  }
+
+  // @return root of the tree holding x
+  int findRoot(int x) {
+    access(x);
+    for (push(x); nodes[x].left != -1; push(x)) {
+      x = nodes[x].left;
+    }
+    splay(x);
+    return x;
+  }
+
+public:
+  // @return id of a new node with the given value, alone in its tree
+  int add(int value) {
+    int x;
+    if (unused.empty()) {
+      x = nodes.size();
+      nodes.push_back(Node());
+    } else {
+      x = unused.back();
+      unused.pop_back();
+    }
+    nodes[x] = Node{-1, -1, -1, false, value, x};
+    return x;
+  }
+
+  // give back a node that is alone in its tree, its id may be reused
+  void remove(int x) { unused.push_back(x); }
+
+  // @return value of node x
+  int value(int x) const { return nodes[x].value; }
+
+  // @return true if a and b are in the same tree
+  bool connected(int a, int b) {
+    return a == b || findRoot(a) == findRoot(b);
+  }
+
+  // add an edge between a and b, which must be in different trees
+  void link(int a, int b) {
+    makeRoot(a);
+    nodes[a].parent = b;
+  }
+
+  // remove the edge between a and b, which must exist
+  void cut(int a, int b) {
+    makeRoot(a);
+    access(b);
+    // the path is a, b so a is all there is left of b
+    nodes[b].left = -1;
+    nodes[a].parent = -1;
+    update(b);
+  }
+
+  // @return node with the largest value on the path from a to b, which
+  // must be in the same tree
+  int pathMax(int a, int b) {
+    makeRoot(a);
+    access(b);
+    return nodes[b].best;
+  }
+};
+
+#endif // LINKCUT_H
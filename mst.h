@@ -0,0 +1,184 @@
+/**
+ * Minimum spanning tree engines over integer vertex ids.
+ * They work on the same graph views as the shortest path engine, see
+ * shortestpath.h, and assume every edge is stored in both directions
+ * with the same weight. Totals are summed in PathLength<Weight>, see
+ * weight.h.
+ */
+
+#ifndef MST_H
+#define MST_H
+
+#include "instrument.h"
+#include "parallel.h"
+#include "unionfind.h"
+#include "weight.h"
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+// an edge chosen for a spanning tree
+template <typename Weight> struct MstEdge {
+  int from;
+  int to;
+  Weight weight;
+};
+
+// every edge of the component holding start, collected once by a
+// breadth-first walk, oriented from the vertex reached first, and
+// stably sorted by weight, so ties are broken the same way on every run
+// @return number of vertices in the component
+template <typename View>
+int kruskalEdges(const View &view, int start,
+                 vector<MstEdge<typename View::Weight>> &edges) {
+  typedef typename View::Weight Weight;
+  vector<bool> seen(view.size(), false);
+  vector<bool> done(view.size(), false);
+  vector<int> q(1, start);
+  seen[start] = true;
+  for (size_t head = 0; head < q.size(); ++head) {
+    int curr = q[head];
+    GRAPH_COUNT(settled, 1);
+    done[curr] = true;
+    view.forEachEdge(curr, [&](int to, Weight weight) {
+      GRAPH_COUNT(relaxed, 1);
+      if (!seen[to]) {
+        seen[to] = true;
+        q.push_back(to);
+      }
+      if (!done[to]) {
+        edges.push_back(MstEdge<Weight>{curr, to, weight});
+      }
+    });
+  }
+  stable_sort(edges.begin(), edges.end(),
+              [](const MstEdge<Weight> &a, const MstEdge<Weight> &b) {
+                return a.weight < b.weight;
+              });
+  return q.size();
+}
+
+// Kruskal's algorithm on the component holding start, over the edges
+// from kruskalEdges
+// @return total weight, the chosen edges are appended to tree in the
+// order they were accepted
+template <typename View>
+PathLength<typename View::Weight>
+kruskalSearch(const View &view, int start,
+              vector<MstEdge<typename View::Weight>> &tree) {
+  typedef typename View::Weight Weight;
+  vector<MstEdge<Weight>> edges;
+  int size;
+  {
+    GRAPH_PHASE(Phase::Setup);
+    size = kruskalEdges(view, start, edges);
+  }
+  GRAPH_PHASE(Phase::Search);
+  DisjointSets sets(view.size());
+  PathLength<Weight> total = 0;
+  // a tree over the component has one edge less than it has vertices
+  size_t needed = size - 1;
+  for (size_t i = 0, accepted = 0; i < edges.size() && accepted < needed;
+       ++i) {
+    if (sets.unite(edges[i].from, edges[i].to)) {
+      tree.push_back(edges[i]);
+      total += edges[i].weight;
+      ++accepted;
+    }
+  }
+  return total;
+}
+
+// Boruvka's algorithm for the minimum spanning forest of every component
+// each round, threads scan disjoint vertex ranges for the lightest edge
+// leaving each vertex's component, then the components are merged along
+// those edges; the number of components at least halves every round
+// ties are broken by vertex ids, so the result does not depend on the
+// number of threads
+// @return total weight of each component's tree, in order of the
+// smallest vertex id in the component; the chosen edges are appended to
+// forest in the order they were accepted
+template <typename View>
+vector<PathLength<typename View::Weight>>
+boruvkaForest(const View &view, int threads,
+              vector<MstEdge<typename View::Weight>> &forest) {
+  typedef typename View::Weight Weight;
+  int n = view.size();
+  // lightest edge first, then by its endpoints as an unordered pair
+  auto lighter = [](const MstEdge<Weight> &a, const MstEdge<Weight> &b) {
+    if (a.weight != b.weight) {
+      return a.weight < b.weight;
+    }
+    int aLow = min(a.from, a.to);
+    int bLow = min(b.from, b.to);
+    if (aLow != bLow) {
+      return aLow < bLow;
+    }
+    return max(a.from, a.to) < max(b.from, b.to);
+  };
+  DisjointSets sets(n);
+  vector<int> component(n);
+  for (int i = 0; i < n; ++i) {
+    component[i] = i;
+  }
+  vector<MstEdge<Weight>> lightest(n);
+  vector<MstEdge<Weight>> best(n);
+  vector<MstEdge<Weight>> accepted;
+  bool merged = true;
+  while (merged) {
+    // lightest edge leaving the component, found from each vertex
+    parallelFor(threads, n, [&](int begin, int end, int) {
+      for (int u = begin; u < end; ++u) {
+        MstEdge<Weight> &found = lightest[u];
+        found.from = -1;
+        view.forEachEdge(u, [&](int to, Weight weight) {
+          MstEdge<Weight> edge{u, to, weight};
+          if (component[to] != component[u] &&
+              (found.from == -1 || lighter(edge, found))) {
+            found = edge;
+          }
+        });
+      }
+    });
+    // reduce to the lightest edge of each component
+    for (int c = 0; c < n; ++c) {
+      best[c].from = -1;
+    }
+    for (int u = 0; u < n; ++u) {
+      MstEdge<Weight> &target = best[component[u]];
+      if (lightest[u].from != -1 &&
+          (target.from == -1 || lighter(lightest[u], target))) {
+        target = lightest[u];
+      }
+    }
+    merged = false;
+    for (int c = 0; c < n; ++c) {
+      if (best[c].from != -1 && sets.unite(best[c].from, best[c].to)) {
+        accepted.push_back(best[c]);
+        merged = true;
+      }
+    }
+    parallelFor(threads, n, [&](int begin, int end, int) {
+      for (int u = begin; u < end; ++u) {
+        component[u] = sets.root(u);
+      }
+    });
+  }
+  // per-component totals, numbered by the smallest id in each component
+  vector<int> index(n, -1);
+  vector<PathLength<Weight>> totals;
+  for (int u = 0; u < n; ++u) {
+    if (index[component[u]] == -1) {
+      index[component[u]] = totals.size();
+      totals.push_back(0);
+    }
+  }
+  for (auto const &edge : accepted) {
+    totals[index[component[edge.from]]] += edge.weight;
+    forest.push_back(edge);
+  }
+  return totals;
+}
+
+#endif // MST_H
@@ -0,0 +1,72 @@
+/**
+ * Small helpers for splitting work across threads.
+ * The calling thread always takes the first share of the work, so a
+ * thread count of 1 never starts a thread.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// @return threads, or one thread per hardware core if threads <= 0
+inline int threadCount(int threads) {
+  if (threads > 0) {
+    return threads;
+  }
+  return max(1u, thread::hardware_concurrency());
+}
+
+// split [0, n) into one contiguous range per thread and call
+// f(begin, end, thread) for each range, returns once all are done
+template <typename F> void parallelFor(int threads, int n, F f) {
+  threads = max(1, min(threadCount(threads), n));
+  vector<thread> workers;
+  for (int t = 1; t < threads; ++t) {
+    int begin = static_cast<long long>(n) * t / threads;
+    int end = static_cast<long long>(n) * (t + 1) / threads;
+    workers.emplace_back(f, begin, end, t);
+  }
+  f(0, static_cast<long long>(n) / threads, 0);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+// makes a fixed team of threads wait for each other between the steps of
+// an algorithm, cheaper than starting new threads for every step
+class SpinBarrier {
+private:
+  int threads;
+  atomic<int> waiting;
+  atomic<int> generation;
+
+public:
+  explicit SpinBarrier(int threads)
+      : threads(threads), waiting(0), generation(0) {}
+
+  SpinBarrier(const SpinBarrier &other) = delete;
+
+  SpinBarrier &operator=(const SpinBarrier &other) = delete;
+
+  // return once all threads have called wait, everything a thread wrote
+  // before the call is then visible to the others
+  void wait() {
+    int current = generation.load(memory_order_acquire);
+    if (waiting.fetch_add(1, memory_order_acq_rel) + 1 == threads) {
+      waiting.store(0, memory_order_relaxed);
+      generation.fetch_add(1, memory_order_release);
+      return;
+    }
+    while (generation.load(memory_order_acquire) == current) {
+      this_thread::yield();
+    }
+  }
+};
+
+#endif // PARALLEL_H
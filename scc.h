@@ -0,0 +1,413 @@
+/**
+ * Strongly connected component engines over integer vertex ids.
+ * tarjanScc runs Tarjan's algorithm in linear time, with its own stack
+ * instead of recursion so long chains cannot overflow the call stack.
+ * parallelScc is the forward-backward search for large graphs: after
+ * trimming vertices that have no edge in or no edge out, it picks a
+ * pivot in a set of vertices, and the vertices both reachable from the
+ * pivot and reaching it are its component. What is left falls into
+ * three smaller sets that cannot share a component, each searched the
+ * same way. Large sets are searched one at a time with every thread
+ * working on each breadth-first level; the small sets left over are
+ * then handed out to the threads whole. Sets are told apart by a color
+ * per vertex, so threads never touch another set's vertices.
+ *
+ * Both number the components the same way, so their results are
+ * identical: ids follow a topological order of the condensation (every
+ * edge between components goes from a lower to a higher id), and among
+ * components free to go next the one holding the smallest vertex id
+ * goes first. The condensation lists each edge between two components
+ * once.
+ */
+
+#ifndef SCC_H
+#define SCC_H
+
+#include "bfs.h"
+#include "instrument.h"
+#include "parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <queue>
+#include <vector>
+
+using namespace std;
+
+// strongly connected components of a graph
+struct SccResult {
+  int count;             // number of components
+  vector<int> component; // component id of every vertex, -1 if none
+  // condensation DAG, the components component c has edges to are
+  // targets[offsets[c] .. offsets[c + 1] - 1], ascending
+  vector<int> offsets;
+  vector<int> targets;
+
+  SccResult() : count(0) {}
+};
+
+// graph view over CSR arrays, so the engines can walk them like a
+// Graph or FrozenGraph; the weight is always 0
+struct CsrArraysView {
+  typedef int Weight;
+  const CsrArrays &arrays;
+  int size() const { return arrays.size; }
+  template <typename F> void forEachEdge(int from, F f) const {
+    for (int i = arrays.offsets[from]; i < arrays.offsets[from + 1]; ++i) {
+      f(arrays.targets[i], 0);
+    }
+  }
+};
+
+// out-edges of view as CSR arrays, in offsets and targets
+template <typename View>
+void viewToCsr(const View &view, vector<int> &offsets,
+               vector<int> &targets) {
+  int n = view.size();
+  offsets.assign(n + 1, 0);
+  targets.clear();
+  for (int v = 0; v < n; ++v) {
+    view.forEachEdge(v, [&targets](int to, typename View::Weight) {
+      targets.push_back(to);
+    });
+    offsets[v + 1] = targets.size();
+  }
+}
+
+// reverse every edge of out, the result's arrays point into offsets and
+// targets
+inline CsrArrays transposeCsr(const CsrArrays &out, vector<int> &offsets,
+                              vector<int> &targets) {
+  int n = out.size;
+  offsets.assign(n + 1, 0);
+  targets.resize(out.offsets[n]);
+  for (int i = 0; i < out.offsets[n]; ++i) {
+    ++offsets[out.targets[i] + 1];
+  }
+  for (int v = 0; v < n; ++v) {
+    offsets[v + 1] += offsets[v];
+  }
+  vector<int> next(offsets.begin(), offsets.end() - 1);
+  for (int v = 0; v < n; ++v) {
+    for (int i = out.offsets[v]; i < out.offsets[v + 1]; ++i) {
+      targets[next[out.targets[i]]++] = v;
+    }
+  }
+  return CsrArrays{n, offsets.data(), targets.data()};
+}
+
+// give components any ids 0..count-1 in raw their final ids, see the
+// top of this file, and build the condensation
+template <typename View>
+SccResult sccNumber(const View &view, const vector<int> &raw, int count) {
+  int n = view.size();
+  SccResult result;
+  result.count = count;
+  // vertices of every component, and its smallest vertex
+  vector<int> first(count + 1, 0);
+  for (int v = 0; v < n; ++v) {
+    ++first[raw[v] + 1];
+  }
+  for (int c = 0; c < count; ++c) {
+    first[c + 1] += first[c];
+  }
+  vector<int> members(n);
+  vector<int> next(first.begin(), first.end() - 1);
+  for (int v = 0; v < n; ++v) {
+    members[next[raw[v]]++] = v;
+  }
+  // edges between components, each once
+  vector<int> edgeFirst(count + 1, 0);
+  vector<int> edges;
+  vector<int> inDegree(count, 0);
+  vector<int> lastFrom(count, -1);
+  for (int c = 0; c < count; ++c) {
+    for (int i = first[c]; i < first[c + 1]; ++i) {
+      view.forEachEdge(members[i], [&](int to, typename View::Weight) {
+        int d = raw[to];
+        if (d != c && lastFrom[d] != c) {
+          lastFrom[d] = c;
+          edges.push_back(d);
+          ++inDegree[d];
+        }
+      });
+    }
+    edgeFirst[c + 1] = edges.size();
+  }
+  // Kahn's algorithm, smallest first vertex first
+  vector<int> id(count);
+  priority_queue<pair<int, int>, vector<pair<int, int>>,
+                 greater<pair<int, int>>>
+      ready;
+  for (int c = 0; c < count; ++c) {
+    if (inDegree[c] == 0) {
+      ready.push(make_pair(members[first[c]], c));
+    }
+  }
+  vector<int> byId;
+  byId.reserve(count);
+  while (!ready.empty()) {
+    int c = ready.top().second;
+    ready.pop();
+    id[c] = byId.size();
+    byId.push_back(c);
+    for (int i = edgeFirst[c]; i < edgeFirst[c + 1]; ++i) {
+      if (--inDegree[edges[i]] == 0) {
+        ready.push(make_pair(members[first[edges[i]]], edges[i]));
+      }
+    }
+  }
+  result.component.resize(n);
+  for (int v = 0; v < n; ++v) {
+    result.component[v] = id[raw[v]];
+  }
+  result.offsets.assign(count + 1, 0);
+  result.targets.reserve(edges.size());
+  for (int i = 0; i < count; ++i) {
+    int c = byId[i];
+    size_t begin = result.targets.size();
+    for (int e = edgeFirst[c]; e < edgeFirst[c + 1]; ++e) {
+      result.targets.push_back(id[edges[e]]);
+    }
+    sort(result.targets.begin() + begin, result.targets.end());
+    result.offsets[i + 1] = result.targets.size();
+  }
+  return result;
+}
+
+// strongly connected components with Tarjan's algorithm
+template <typename View> SccResult tarjanScc(const View &view) {
+  int n = view.size();
+  vector<int> index(n, -1);
+  vector<int> low(n, 0);
+  vector<bool> onStack(n, false);
+  vector<int> raw(n, -1);
+  int count = 0;
+  int clock = 0;
+  // vertices not yet assigned to a component, in the order entered
+  vector<int> open;
+  // neighbours of every vertex on the call stack, as in dfs.h
+  vector<int> pending;
+  struct Frame {
+    int vertex;
+    size_t begin;
+    size_t next;
+  };
+  vector<Frame> stack;
+  auto enter = [&](int v) {
+    GRAPH_COUNT(settled, 1);
+    index[v] = low[v] = clock++;
+    open.push_back(v);
+    onStack[v] = true;
+    stack.push_back(Frame{v, pending.size(), pending.size()});
+    view.forEachEdge(v, [&pending](int to, typename View::Weight) {
+      pending.push_back(to);
+    });
+  };
+  for (int root = 0; root < n; ++root) {
+    if (index[root] != -1) {
+      continue;
+    }
+    enter(root);
+    while (!stack.empty()) {
+      Frame &top = stack.back();
+      int v = top.vertex;
+      if (top.next == pending.size()) {
+        if (low[v] == index[v]) {
+          // v is the first vertex entered of its component
+          int w;
+          do {
+            w = open.back();
+            open.pop_back();
+            onStack[w] = false;
+            raw[w] = count;
+          } while (w != v);
+          ++count;
+        }
+        pending.resize(top.begin);
+        stack.pop_back();
+        if (!stack.empty()) {
+          int parent = stack.back().vertex;
+          low[parent] = min(low[parent], low[v]);
+          ++stack.back().next;
+        }
+        continue;
+      }
+      int to = pending[top.next];
+      GRAPH_COUNT(relaxed, 1);
+      if (index[to] == -1) {
+        enter(to);
+        continue;
+      }
+      if (onStack[to]) {
+        low[v] = min(low[v], index[to]);
+      }
+      ++top.next;
+    }
+  }
+  return sccNumber(view, raw, count);
+}
+
+// breadth-first search from start over edges for parallelScc, claim(w)
+// recolors w if it belongs to the search and returns true if it did
+// each level is split over up to threads threads, local holds one list
+// per thread
+template <typename Claim>
+void sccReach(const CsrArrays &edges, int start, int threads,
+              vector<vector<int>> &local, Claim claim) {
+  // frontiers smaller than this per thread are not worth a thread
+  const int GRAIN = 4096;
+  vector<int> frontier(1, start);
+  while (!frontier.empty()) {
+    int size = frontier.size();
+    int useThreads = min(threads, 1 + size / GRAIN);
+    parallelFor(useThreads, size, [&](int begin, int end, int t) {
+      for (int f = begin; f < end; ++f) {
+        int v = frontier[f];
+        for (int i = edges.offsets[v]; i < edges.offsets[v + 1]; ++i) {
+          if (claim(edges.targets[i])) {
+            local[t].push_back(edges.targets[i]);
+          }
+        }
+      }
+    });
+    frontier.clear();
+    for (int t = 0; t < useThreads; ++t) {
+      frontier.insert(frontier.end(), local[t].begin(), local[t].end());
+      local[t].clear();
+    }
+  }
+}
+
+// strongly connected components with the forward-backward search, out
+// holds the out-edges and in the in-edges (the same arrays for
+// undirected graphs), threads threads (0 = one per core)
+inline SccResult parallelScc(const CsrArrays &out, const CsrArrays &in,
+                             int threads) {
+  // sets smaller than this are searched by one thread
+  const size_t LARGE = 4096;
+  int n = out.size;
+  threads = threadCount(threads);
+  vector<int> raw(n, -1);
+  int count = 0;
+
+  // trim: a vertex without edges in or out among the vertices left is
+  // a component of its own
+  vector<int> inLeft(n);
+  vector<int> outLeft(n);
+  vector<int> trimmed;
+  for (int v = 0; v < n; ++v) {
+    outLeft[v] = out.offsets[v + 1] - out.offsets[v];
+    inLeft[v] = in.offsets[v + 1] - in.offsets[v];
+    if (inLeft[v] == 0 || outLeft[v] == 0) {
+      raw[v] = count++;
+      trimmed.push_back(v);
+    }
+  }
+  for (size_t head = 0; head < trimmed.size(); ++head) {
+    int v = trimmed[head];
+    auto trim = [&](const CsrArrays &edges, vector<int> &left) {
+      for (int i = edges.offsets[v]; i < edges.offsets[v + 1]; ++i) {
+        int w = edges.targets[i];
+        if (raw[w] == -1 && --left[w] == 0) {
+          raw[w] = count++;
+          trimmed.push_back(w);
+        }
+      }
+    };
+    trim(out, inLeft);
+    trim(in, outLeft);
+  }
+
+  // a set of vertices that may still share components, all of color
+  struct Task {
+    int color;
+    vector<int> vertices;
+  };
+  // colors are never reused, so a set only ever sees its own
+  vector<atomic<int>> color(n);
+  atomic<int> nextColor(1);
+  atomic<int> nextComponent(count);
+  Task all{0, vector<int>()};
+  for (int v = 0; v < n; ++v) {
+    color[v].store(raw[v] == -1 ? 0 : -1, memory_order_relaxed);
+    if (raw[v] == -1) {
+      all.vertices.push_back(v);
+    }
+  }
+
+  // @return true if v was recolored from expected to to
+  auto recolor = [&color](int v, int expected, int to) {
+    return color[v].load(memory_order_relaxed) == expected &&
+           color[v].compare_exchange_strong(expected, to,
+                                            memory_order_relaxed);
+  };
+  // find the component of the first vertex of task, the rest of task
+  // is split into tasks pushed onto more
+  auto split = [&](Task &task, int useThreads, vector<vector<int>> &local,
+                   vector<Task> &more) {
+    int c = task.color;
+    int forward = nextColor++;
+    int backward = nextColor++;
+    int both = nextColor++;
+    int pivot = task.vertices[0];
+    color[pivot].store(both, memory_order_relaxed);
+    sccReach(out, pivot, useThreads, local,
+             [&](int w) { return recolor(w, c, forward); });
+    sccReach(in, pivot, useThreads, local, [&](int w) {
+      return recolor(w, forward, both) || recolor(w, c, backward);
+    });
+    int component = nextComponent++;
+    Task parts[3] = {{forward, vector<int>()},
+                     {backward, vector<int>()},
+                     {c, vector<int>()}};
+    for (int v : task.vertices) {
+      int now = color[v].load(memory_order_relaxed);
+      if (now == both) {
+        raw[v] = component;
+        color[v].store(-1, memory_order_relaxed);
+      } else {
+        parts[now == forward ? 0 : now == backward ? 1 : 2]
+            .vertices.push_back(v);
+      }
+    }
+    for (Task &part : parts) {
+      if (!part.vertices.empty()) {
+        more.push_back(move(part));
+      }
+    }
+  };
+
+  // large sets one at a time, every thread on each level
+  vector<vector<int>> local(threads);
+  vector<Task> large;
+  vector<Task> small;
+  if (!all.vertices.empty()) {
+    large.push_back(move(all));
+  }
+  while (!large.empty()) {
+    Task task = move(large.back());
+    large.pop_back();
+    if (task.vertices.size() < LARGE) {
+      small.push_back(move(task));
+      continue;
+    }
+    split(task, threads, local, large);
+  }
+  // small sets handed out whole, each thread splits its own further
+  atomic<size_t> nextSmall(0);
+  parallelFor(threads, small.size(), [&](int, int, int) {
+    vector<vector<int>> mine(1);
+    vector<Task> todo;
+    for (size_t i = nextSmall++; i < small.size(); i = nextSmall++) {
+      todo.push_back(move(small[i]));
+      while (!todo.empty()) {
+        Task task = move(todo.back());
+        todo.pop_back();
+        split(task, 1, mine, todo);
+      }
+    }
+  });
+  return sccNumber(CsrArraysView{out}, raw, nextComponent.load());
+}
+
+#endif // SCC_H
@@ -0,0 +1,223 @@
+/**
+ * Dijkstra's shortest path engine over integer vertex ids.
+ * The engine works on any graph view that provides
+ *   typedef ... Weight;
+ *   int size() const;                               // number of ids
+ *   template <typename F> void forEachEdge(int from, F f) const;
+ * where forEachEdge calls f(int to, Weight weight) once per edge.
+ * Edge weights are assumed to be non-negative. Distances are summed in
+ * PathLength<Weight>, and a path too long for it is not taken, see
+ * weight.h.
+ *
+ * distanceSearch answers many sources against many targets at once and
+ * fills a dense matrix. Each thread keeps one distance array and heap
+ * for all of its sources and resets only the entries a search touched,
+ * a search stops as soon as every target is settled, and a source that
+ * appears twice is searched once.
+ */
+
+#ifndef SHORTESTPATH_H
+#define SHORTESTPATH_H
+
+#include "deltastepping.h"
+#include "heap.h"
+#include "parallel.h"
+#include "weight.h"
+#include <atomic>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+// priority queue used by dijkstra and shortestPath
+enum class HeapKind { Binary, FourAry, Pairing };
+
+// tuning knobs for dijkstra and shortestPath
+struct DijkstraOptions {
+  HeapKind heap;
+  // delta-stepping on several threads instead of one heap, see
+  // deltastepping.h; the heap is then not used
+  bool parallel;
+  // threads for the parallel search, 0 = one per core
+  int threads;
+  // bucket width for the parallel search, 0 = picked from the weights
+  // wide buckets mean fewer rounds but more work redone in each
+  double bucketWidth;
+  DijkstraOptions()
+      : heap(HeapKind::Binary), parallel(false), threads(0),
+        bucketWidth(0) {}
+};
+
+// single source shortest paths from source using the given heap
+// stops as soon as target is settled, pass -1 to settle every vertex
+// dist[v] is numeric_limits<Length>::max() and prev[v] is -1 if v
+// was not reached
+template <typename Heap, typename View>
+void dijkstraSearch(const View &view, int source, int target,
+                    vector<PathLength<typename View::Weight>> &dist,
+                    vector<int> &prev) {
+  typedef typename View::Weight Weight;
+  typedef PathLength<Weight> Length;
+  dist.assign(view.size(), numeric_limits<Length>::max());
+  prev.assign(view.size(), -1);
+  Heap heap(view.size());
+  dist[source] = 0;
+  heap.push(source, 0);
+  while (!heap.empty()) {
+    int curr = heap.pop();
+    GRAPH_COUNT(settled, 1);
+    if (curr == target) {
+      return;
+    }
+    Length base = dist[curr];
+    view.forEachEdge(curr, [&](int to, Weight weight) {
+      GRAPH_COUNT(relaxed, 1);
+      Length length;
+      if (extendPath(base, weight, length) && length < dist[to]) {
+        dist[to] = length;
+        prev[to] = curr;
+        heap.push(to, dist[to]);
+      }
+    });
+  }
+}
+
+// single source shortest paths, heap or parallel search chosen at run
+// time
+template <typename View>
+void dijkstraSearch(const View &view, int source, int target,
+                    const DijkstraOptions &options,
+                    vector<PathLength<typename View::Weight>> &dist,
+                    vector<int> &prev) {
+  typedef PathLength<typename View::Weight> Length;
+  if (options.parallel) {
+    deltaSteppingSearch(view, source, target, options.threads,
+                        options.bucketWidth, dist, prev);
+    return;
+  }
+  switch (options.heap) {
+  case HeapKind::FourAry:
+    dijkstraSearch<FourAryHeap<Length>>(view, source, target, dist, prev);
+    break;
+  case HeapKind::Pairing:
+    dijkstraSearch<PairingHeap<Length>>(view, source, target, dist, prev);
+    break;
+  default:
+    dijkstraSearch<BinaryHeap<Length>>(view, source, target, dist, prev);
+    break;
+  }
+}
+
+// distances from a list of sources to a list of targets, row-major
+template <typename Weight> struct DistanceMatrix {
+  int rows;                 // one per source
+  int columns;              // one per target
+  vector<Weight> distances; // rows * columns entries
+
+  // @return distance from source row to target column
+  Weight at(int row, int column) const {
+    return distances[static_cast<size_t>(row) * columns + column];
+  }
+};
+
+// distance from every source to every target, sources are split across
+// threads (0 = one per core)
+// a source or target of -1 stands for a missing vertex
+// @return matrix with numeric_limits<Length>::max() where the target is
+// not reachable or either vertex is missing
+template <typename View>
+DistanceMatrix<PathLength<typename View::Weight>>
+distanceSearch(const View &view, const vector<int> &sources,
+               const vector<int> &targets, int threads) {
+  typedef typename View::Weight Weight;
+  typedef PathLength<Weight> Length;
+  const Length INF = numeric_limits<Length>::max();
+  int n = view.size();
+  DistanceMatrix<Length> matrix;
+  matrix.rows = sources.size();
+  matrix.columns = targets.size();
+  matrix.distances.assign(sources.size() * targets.size(), INF);
+  // each distinct target counts once towards stopping a search
+  vector<char> isTarget(n, 0);
+  int targetCount = 0;
+  for (int t : targets) {
+    if (t != -1 && isTarget[t] == 0) {
+      isTarget[t] = 1;
+      ++targetCount;
+    }
+  }
+  // search each distinct source once, repeats copy its row afterwards
+  vector<int> firstRow(n, -1);
+  vector<int> unique;
+  for (int row = 0; row < matrix.rows; ++row) {
+    int s = sources[row];
+    if (s != -1 && firstRow[s] == -1) {
+      firstRow[s] = row;
+      unique.push_back(row);
+    }
+  }
+  if (targetCount == 0) {
+    return matrix;
+  }
+  // sources differ a lot in cost, so threads take them one at a time
+  atomic<int> nextSource(0);
+  threads = max(1, min<int>(threadCount(threads), unique.size()));
+  parallelFor(threads, threads, [&](int, int, int) {
+    vector<Length> dist(n, INF);
+    vector<int> touched;
+    BinaryHeap<Length> heap(n);
+    for (int i = nextSource++; i < static_cast<int>(unique.size());
+         i = nextSource++) {
+      int row = unique[i];
+      int source = sources[row];
+      int remaining = targetCount;
+      dist[source] = 0;
+      touched.push_back(source);
+      heap.push(source, 0);
+      while (!heap.empty()) {
+        int curr = heap.pop();
+        GRAPH_COUNT(settled, 1);
+        if (isTarget[curr] != 0 && --remaining == 0) {
+          break;
+        }
+        Length base = dist[curr];
+        view.forEachEdge(curr, [&](int to, Weight weight) {
+          GRAPH_COUNT(relaxed, 1);
+          Length length;
+          if (extendPath(base, weight, length) && length < dist[to]) {
+            if (dist[to] == INF) {
+              touched.push_back(to);
+            }
+            dist[to] = length;
+            heap.push(to, dist[to]);
+          }
+        });
+      }
+      Length *out = &matrix.distances[static_cast<size_t>(row) *
+                                      matrix.columns];
+      for (int c = 0; c < matrix.columns; ++c) {
+        if (targets[c] != -1) {
+          out[c] = dist[targets[c]];
+        }
+      }
+      for (int v : touched) {
+        dist[v] = INF;
+      }
+      touched.clear();
+      heap.clear();
+    }
+  });
+  for (int row = 0; row < matrix.rows; ++row) {
+    int s = sources[row];
+    if (s != -1 && firstRow[s] != row) {
+      copy_n(matrix.distances.begin() +
+                 static_cast<size_t>(firstRow[s]) * matrix.columns,
+             matrix.columns,
+             matrix.distances.begin() +
+                 static_cast<size_t>(row) * matrix.columns);
+    }
+  }
+  return matrix;
+}
+
+#endif // SHORTESTPATH_H
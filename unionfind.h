@@ -0,0 +1,73 @@
+/**
+ * DisjointSets keeps ids 0..n-1 in disjoint sets.
+ * Union by rank and path halving keep every operation close to O(1)
+ * amortized, which is what Kruskal's algorithm needs to reject edges
+ * that would close a cycle.
+ */
+
+#ifndef UNIONFIND_H
+#define UNIONFIND_H
+
+#include "instrument.h"
+#include <vector>
+
+using namespace std;
+
+class DisjointSets {
+private:
+  vector<int> parent;
+  vector<unsigned char> rank;
+  int sets;
+
+public:
+  // n sets, each holding one id
+  explicit DisjointSets(int n) : parent(n), rank(n, 0), sets(n) {
+    for (int i = 0; i < n; ++i) {
+      parent[i] = i;
+    }
+  }
+
+  // @return representative of the set holding id
+  int find(int id) {
+    GRAPH_COUNT(unionFinds, 1);
+    while (parent[id] != id) {
+      parent[id] = parent[parent[id]];
+      id = parent[id];
+    }
+    return id;
+  }
+
+  // @return representative of the set holding id, without compressing
+  // paths, so several threads may call it while no set is being merged
+  int root(int id) const {
+    while (parent[id] != id) {
+      id = parent[id];
+    }
+    return id;
+  }
+
+  // merge the sets holding a and b
+  // @return false if they were already in the same set
+  bool unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+      return false;
+    }
+    if (rank[a] < rank[b]) {
+      parent[a] = b;
+    } else {
+      parent[b] = a;
+      if (rank[a] == rank[b]) {
+        ++rank[a];
+      }
+    }
+    --sets;
+    return true;
+  }
+
+  // @return number of disjoint sets
+  int count() const { return sets; }
+};
+
+#endif // UNIONFIND_H
@@ -0,0 +1,35 @@
+/**
+ * Calling the visitors given to the templated traversals.
+ * A visitor is any callable. It may return nothing, or a value that
+ * converts to bool, in which case false stops the traversal early.
+ * Either way the call is made directly, so the compiler can inline it.
+ */
+
+#ifndef VISITOR_H
+#define VISITOR_H
+
+#include <type_traits>
+#include <utility>
+
+using namespace std;
+
+// call a visitor that returns nothing
+// @return true, the traversal goes on
+template <typename Visit, typename... Args>
+auto visitAndContinue(Visit &visit, Args &&...args) ->
+    typename enable_if<is_void<decltype(visit(forward<Args>(args)...))>::value,
+                       bool>::type {
+  visit(forward<Args>(args)...);
+  return true;
+}
+
+// call a visitor that returns a value
+// @return false if the traversal should stop
+template <typename Visit, typename... Args>
+auto visitAndContinue(Visit &visit, Args &&...args) ->
+    typename enable_if<!is_void<decltype(visit(forward<Args>(args)...))>::value,
+                       bool>::type {
+  return static_cast<bool>(visit(forward<Args>(args)...));
+}
+
+#endif // VISITOR_H
@@ -0,0 +1,43 @@
+/**
+ * Edge weight types.
+ * A Graph can hold any arithmetic weight type, see BasicGraph. The
+ * length of a path is summed in PathLength<Weight>, the type of
+ * Weight + Weight: 16-bit weights add up in int instead of wrapping at
+ * 65535, while int, 64-bit and floating point weights keep their type.
+ * The largest value of the length type marks a vertex that cannot be
+ * reached, so extendPath refuses a sum that would reach it rather than
+ * overflow. Sums over a whole graph are kept in WeightTotal<Weight>.
+ */
+
+#ifndef WEIGHT_H
+#define WEIGHT_H
+
+#include <limits>
+#include <type_traits>
+
+using namespace std;
+
+// type the lengths of paths over edges of type Weight are summed in
+template <typename Weight> using PathLength = decltype(Weight() + Weight());
+
+// type sums over every edge of a graph are kept in, such as the total
+// weight of its edges: long long, or double for floating point weights
+template <typename Weight>
+using WeightTotal =
+    typename conditional<is_floating_point<Weight>::value, double,
+                         long long>::type;
+
+// sum = base + weight, for the length base of a path that was reached
+// and the weight of an edge leaving it, which must not be negative
+// @return false if the sum would reach numeric_limits<Length>::max(),
+// the edge then leads nowhere
+template <typename Length, typename Weight>
+inline bool extendPath(Length base, Weight weight, Length &sum) {
+  if (static_cast<Length>(weight) >= numeric_limits<Length>::max() - base) {
+    return false;
+  }
+  sum = base + weight;
+  return true;
+}
+
+#endif // WEIGHT_H